@@ -0,0 +1,201 @@
+/*
+ * Micro-benchmark of receive buffer scanning: SWAR scanners of utils/byte_scan.c against byte-by-byte loops.
+ *   last-digit  - byte_scan_last_in_range, the original backward loop of on_tcp_server_receive (UDP commands)
+ *   first-digit - byte_scan_first_in_range, next digit command on TCP receive path
+ *   first-magic - byte_scan_first, next frame start on TCP receive path
+ * Every scanner result is checked against its bytewise loop before it is timed.
+ *
+ * Both sides are timed through the same call depth (table wrapper calling out-of-line scanner), so short buffers,
+ * which SWAR scanners handle with plain loop too, compare call for call.
+ *
+ * Usage: bench_byte_scan [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "byte_scan.h"
+
+#define PAYLOAD_MAX_SZ						1460
+#define DIGITS_START						'0'
+#define DIGITS_END							'7'
+#define FRAME_MAGIC							0xA5
+
+// Original loop of on_tcp_server_receive (returns index of processed digit instead of processing it)
+static __attribute__((noinline)) sint32 last_digit_loop(const uint8* data, uint16 length)
+{
+	char last_char = 0;
+	unsigned short idx;
+	for (idx = length; idx > 0 && !last_char; --idx)
+	{
+		last_char = data[idx - 1];
+		if (last_char >= DIGITS_START && last_char <= DIGITS_END)
+		{
+			return idx - 1;
+		}
+		else
+		{
+			last_char = 0;
+		}
+	}
+	return -1;
+}
+
+static sint32 last_digit_bytewise(const uint8* data, uint16 length)
+{
+	return last_digit_loop(data, length);
+}
+
+static sint32 last_digit_swar(const uint8* data, uint16 length)
+{
+	return byte_scan_last_in_range(data, length, DIGITS_START, DIGITS_END);
+}
+
+static __attribute__((noinline)) uint16 first_digit_loop(const uint8* data, uint16 length)
+{
+	uint16 idx;
+	for (idx = 0; idx < length; ++idx)
+	{
+		if (data[idx] >= DIGITS_START && data[idx] <= DIGITS_END)
+		{
+			break;
+		}
+	}
+	return idx;
+}
+
+static sint32 first_digit_bytewise(const uint8* data, uint16 length)
+{
+	return first_digit_loop(data, length);
+}
+
+static sint32 first_digit_swar(const uint8* data, uint16 length)
+{
+	return byte_scan_first_in_range(data, length, DIGITS_START, DIGITS_END);
+}
+
+static __attribute__((noinline)) uint16 first_magic_loop(const uint8* data, uint16 length)
+{
+	uint16 idx;
+	for (idx = 0; idx < length && data[idx] != FRAME_MAGIC; ++idx)
+	{
+	}
+	return idx;
+}
+
+static sint32 first_magic_bytewise(const uint8* data, uint16 length)
+{
+	return first_magic_loop(data, length);
+}
+
+static sint32 first_magic_swar(const uint8* data, uint16 length)
+{
+	return byte_scan_first(data, length, FRAME_MAGIC);
+}
+
+struct scanner
+{
+	const char* name;
+	sint32 (* bytewise)(const uint8* data, uint16 length);
+	sint32 (* swar)(const uint8* data, uint16 length);
+};
+
+static const struct scanner scanners[] =
+{
+	{ "last-digit", last_digit_bytewise, last_digit_swar },
+	{ "first-digit", first_digit_bytewise, first_digit_swar },
+	{ "first-magic", first_magic_bytewise, first_magic_swar },
+};
+
+static double now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Payload patterns: text padding without digits or magic (worst case), match at the very beginning
+// (digit for digit scanners, magic for magic scanner), random printable text with digits and occasional magic
+static void fill_payload(uint8* buf, uint16 length, int pattern, uint8 first)
+{
+	uint16 idx;
+	for (idx = 0; idx < length; ++idx)
+	{
+		switch (pattern)
+		{
+			case 0:
+				buf[idx] = 'a' + idx % 26;
+				break;
+			case 1:
+				buf[idx] = idx ? ' ' : first;
+				break;
+			default:
+				buf[idx] = rand() % 64 ? 0x20 + rand() % 0x5F : FRAME_MAGIC;
+				break;
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	static const char* pattern_names[] = { "no-match", "match-first", "random-text" };
+	static const uint16 sizes[] = { 1, 2, 3, 4, 7, 8, 16, 32, 64, 128, 256, 512, 1024, 1460 };
+	long iterations = argc > 1 ? atol(argv[1]) : 200000;
+	// Extra space lets payload start at every alignment offset
+	static uint8 storage[PAYLOAD_MAX_SZ + 8] __attribute__((aligned(4)));
+	volatile sint32 sink = 0;
+	size_t scanner_idx;
+	int pattern;
+	size_t size_idx;
+
+	srand(1);
+	printf("%-12s %-12s %6s %14s %14s %8s\n", "scanner", "pattern", "size", "bytewise ns", "swar ns", "speedup");
+	for (scanner_idx = 0; scanner_idx < sizeof(scanners) / sizeof(scanners[0]); ++scanner_idx)
+	{
+		const struct scanner* scanner = &scanners[scanner_idx];
+		uint8 first = scanner->swar == first_magic_swar ? FRAME_MAGIC : '5';
+		for (pattern = 0; pattern < 3; ++pattern)
+		{
+			for (size_idx = 0; size_idx < sizeof(sizes) / sizeof(sizes[0]); ++size_idx)
+			{
+				uint16 size = sizes[size_idx];
+				double bytewise_ns = 0;
+				double swar_ns = 0;
+				int offset;
+				for (offset = 0; offset < 4; ++offset)
+				{
+					uint8* payload = storage + offset;
+					long it;
+					double started;
+					fill_payload(payload, size, pattern, first);
+					if (scanner->bytewise(payload, size) != scanner->swar(payload, size))
+					{
+						fprintf(stderr, "Mismatch: scanner %s, pattern %s, size %d, offset %d\n",
+								scanner->name, pattern_names[pattern], size, offset);
+						return 1;
+					}
+					started = now_ns();
+					for (it = 0; it < iterations; ++it)
+					{
+						sink += scanner->bytewise(payload, size);
+						__asm__ volatile("" ::: "memory");
+					}
+					bytewise_ns += now_ns() - started;
+					started = now_ns();
+					for (it = 0; it < iterations; ++it)
+					{
+						sink += scanner->swar(payload, size);
+						__asm__ volatile("" ::: "memory");
+					}
+					swar_ns += now_ns() - started;
+				}
+				bytewise_ns /= 4.0 * iterations;
+				swar_ns /= 4.0 * iterations;
+				printf("%-12s %-12s %6d %14.2f %14.2f %7.2fx\n", scanner->name, pattern_names[pattern], size,
+						bytewise_ns, swar_ns, bytewise_ns / swar_ns);
+			}
+		}
+	}
+	return sink == 0x7FFFFFFF;
+}
@@ -0,0 +1,44 @@
+/*
+ * c_types.h
+ *
+ * Linux host build stand-in for the ESP8266 NON OS SDK basic types header.
+ */
+
+#ifndef HOST_INCLUDE_C_TYPES_H_
+#define HOST_INCLUDE_C_TYPES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef unsigned char		uint8;
+typedef signed char			sint8;
+typedef unsigned short		uint16;
+typedef signed short		sint16;
+typedef unsigned int		uint32;
+typedef signed int			sint32;
+typedef unsigned long long	uint64;
+typedef signed long long	sint64;
+typedef float				real32;
+typedef double				real64;
+
+typedef enum
+{
+	OK = 0,
+	FAIL,
+	PENDING,
+	BUSY,
+	CANCEL,
+} STATUS;
+
+#define LOCAL				static
+
+// Flash placement attributes have no meaning on host - everything lives in regular memory
+#define ICACHE_FLASH_ATTR
+#define ICACHE_RODATA_ATTR
+#define ICACHE_RAM_ATTR
+#define STORE_ATTR			__attribute__((aligned(4)))
+
+#define BIT(nr)				(1UL << (nr))
+
+#endif /* HOST_INCLUDE_C_TYPES_H_ */
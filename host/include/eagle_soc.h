@@ -0,0 +1,61 @@
+/*
+ * eagle_soc.h
+ *
+ * Linux host build stand-in for the ESP8266 NON OS SDK peripheral registers header.
+ * Peripheral registers are backed by in-memory register file (see host/shim/shim_regs.c),
+ * register writes go through shim, so that UART FIFO writes reach stdout.
+ */
+
+#ifndef HOST_INCLUDE_EAGLE_SOC_H_
+#define HOST_INCLUDE_EAGLE_SOC_H_
+
+#include "c_types.h"
+
+// Peripheral address space covered by host register file
+#define HOST_PERI_BASEADDR			0x60000000
+#define HOST_PERI_SIZE				0x1000
+
+volatile uint32* host_peri_reg(uint32 addr);
+void host_peri_write(uint32 addr, uint32 value);
+
+#define READ_PERI_REG(addr)			(*host_peri_reg((uint32)(addr)))
+#define WRITE_PERI_REG(addr, val)	host_peri_write((uint32)(addr), (uint32)(val))
+#define CLEAR_PERI_REG_MASK(reg, mask)	WRITE_PERI_REG((reg), (READ_PERI_REG(reg) & (~(mask))))
+#define SET_PERI_REG_MASK(reg, mask)	WRITE_PERI_REG((reg), (READ_PERI_REG(reg) | (mask)))
+
+// GPIO registers
+#define PERIPHS_GPIO_BASEADDR		0x60000300
+#define GPIO_OUT_ADDRESS			0x00
+#define GPIO_OUT_W1TS_ADDRESS		0x04
+#define GPIO_OUT_W1TC_ADDRESS		0x08
+#define GPIO_ENABLE_ADDRESS			0x0c
+#define GPIO_ENABLE_W1TS_ADDRESS	0x10
+#define GPIO_ENABLE_W1TC_ADDRESS	0x14
+#define GPIO_IN_ADDRESS				0x18
+#define GPIO_STATUS_ADDRESS			0x1c
+
+#define GPIO_REG_READ(reg)			READ_PERI_REG(PERIPHS_GPIO_BASEADDR + (reg))
+#define GPIO_REG_WRITE(reg, val)	WRITE_PERI_REG(PERIPHS_GPIO_BASEADDR + (reg), (val))
+
+// IO MUX registers
+#define PERIPHS_IO_MUX				0x60000800
+#define PERIPHS_IO_MUX_MTDI_U		(PERIPHS_IO_MUX + 0x04)
+#define PERIPHS_IO_MUX_MTCK_U		(PERIPHS_IO_MUX + 0x08)
+#define PERIPHS_IO_MUX_MTMS_U		(PERIPHS_IO_MUX + 0x0C)
+#define PERIPHS_IO_MUX_GPIO2_U		(PERIPHS_IO_MUX + 0x38)
+
+#define PERIPHS_IO_MUX_FUNC			0x13
+#define PERIPHS_IO_MUX_FUNC_S		4
+
+#define FUNC_GPIO2					0
+#define FUNC_GPIO12					3
+#define FUNC_GPIO13					3
+#define FUNC_GPIO14					3
+
+#define PIN_FUNC_SELECT(PIN_NAME, FUNC) do { \
+	WRITE_PERI_REG(PIN_NAME, \
+		(READ_PERI_REG(PIN_NAME) & ~(PERIPHS_IO_MUX_FUNC << PERIPHS_IO_MUX_FUNC_S)) \
+		| ((((FUNC & BIT(2)) << 2) | (FUNC & 0x3)) << PERIPHS_IO_MUX_FUNC_S)); \
+	} while (0)
+
+#endif /* HOST_INCLUDE_EAGLE_SOC_H_ */
@@ -0,0 +1,26 @@
+/*
+ * ets_sys.h
+ *
+ * Linux host build stand-in for the ESP8266 NON OS SDK system header.
+ * Interrupts are emulated by host shim and delivered from event loop (see host/shim/shim_uart.c).
+ */
+
+#ifndef HOST_INCLUDE_ETS_SYS_H_
+#define HOST_INCLUDE_ETS_SYS_H_
+
+#include "c_types.h"
+#include "eagle_soc.h"
+
+#define ETS_UART_INUM				5
+
+typedef void (* ets_isr_t)(void* arg);
+
+void ets_isr_attach(int inum, ets_isr_t handler, void* arg);
+void ets_isr_mask(uint32 mask);
+void ets_isr_unmask(uint32 mask);
+
+#define ETS_UART_INTR_ATTACH(func, arg)	ets_isr_attach(ETS_UART_INUM, (ets_isr_t)(func), (void*)(arg))
+#define ETS_UART_INTR_ENABLE()			ets_isr_unmask(1 << ETS_UART_INUM)
+#define ETS_UART_INTR_DISABLE()			ets_isr_mask(1 << ETS_UART_INUM)
+
+#endif /* HOST_INCLUDE_ETS_SYS_H_ */
@@ -0,0 +1,21 @@
+/*
+ * gpio.h
+ *
+ * Linux host build stand-in for the ESP8266 NON OS SDK GPIO API header.
+ */
+
+#ifndef HOST_INCLUDE_GPIO_H_
+#define HOST_INCLUDE_GPIO_H_
+
+#include "c_types.h"
+#include "eagle_soc.h"
+
+#define GPIO_OUTPUT_SET(gpio_no, bit_value) \
+	gpio_output_set((bit_value) << (gpio_no), ((~(bit_value)) & 0x01) << (gpio_no), 1 << (gpio_no), 0)
+#define GPIO_INPUT_GET(gpio_no)		((gpio_input_get() >> (gpio_no)) & BIT(0))
+
+void gpio_init(void);
+void gpio_output_set(uint32 set_mask, uint32 clear_mask, uint32 enable_mask, uint32 disable_mask);
+uint32 gpio_input_get(void);
+
+#endif /* HOST_INCLUDE_GPIO_H_ */
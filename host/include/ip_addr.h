@@ -0,0 +1,31 @@
+/*
+ * ip_addr.h
+ *
+ * Linux host build stand-in for the lwIP IPv4 address header shipped with ESP8266 NON OS SDK.
+ */
+
+#ifndef HOST_INCLUDE_IP_ADDR_H_
+#define HOST_INCLUDE_IP_ADDR_H_
+
+#include "c_types.h"
+
+struct ip_addr
+{
+	uint32 addr;
+};
+
+typedef struct ip_addr ip_addr_t;
+
+struct ip_info
+{
+	struct ip_addr ip;
+	struct ip_addr netmask;
+	struct ip_addr gw;
+};
+
+// Address is kept in network byte order (ESP8266 is little-endian, so does the host)
+#define IP4_ADDR(ipaddr, a, b, c, d) \
+	(ipaddr)->addr = ((uint32)((d) & 0xff) << 24) | ((uint32)((c) & 0xff) << 16) | \
+					 ((uint32)((b) & 0xff) << 8) | (uint32)((a) & 0xff)
+
+#endif /* HOST_INCLUDE_IP_ADDR_H_ */
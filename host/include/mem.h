@@ -0,0 +1,20 @@
+/*
+ * mem.h
+ *
+ * Linux host build stand-in for the ESP8266 NON OS SDK heap API header.
+ * Allocations are accounted against emulated device heap size.
+ */
+
+#ifndef HOST_INCLUDE_MEM_H_
+#define HOST_INCLUDE_MEM_H_
+
+#include "c_types.h"
+
+void* host_malloc(size_t size, bool zero);
+void host_free(void* ptr);
+
+#define os_malloc(s)		host_malloc((s), false)
+#define os_zalloc(s)		host_malloc((s), true)
+#define os_free(p)			host_free(p)
+
+#endif /* HOST_INCLUDE_MEM_H_ */
@@ -0,0 +1,52 @@
+/*
+ * os_type.h
+ *
+ * Linux host build stand-in for the ESP8266 NON OS SDK timer types header.
+ */
+
+#ifndef HOST_INCLUDE_OS_TYPE_H_
+#define HOST_INCLUDE_OS_TYPE_H_
+
+#include "c_types.h"
+
+// Event loop registration record. Every timer and socket of the shim is dispatched through it.
+typedef struct host_io host_io_t;
+struct host_io
+{
+	int fd;
+	void (*handler)(host_io_t* io, uint32 events);
+};
+
+typedef void ETSTimerFunc(void* timer_arg);
+
+// Host timer is backed by timerfd instead of the ETS timer list
+typedef struct _ETSTIMER_
+{
+	host_io_t io;
+	ETSTimerFunc* timer_func;
+	void* timer_arg;
+	uint32 timer_period;
+	bool timer_created;
+} ETSTimer;
+
+#define os_timer_t			ETSTimer
+#define os_timer_func_t		ETSTimerFunc
+
+// Task event parameter is pointer-wide on host, so firmware can pass pointers through it as on 32-bit target
+typedef uint32 ETSSignal;
+typedef uintptr_t ETSParam;
+
+typedef struct ETSEventTag
+{
+	ETSSignal sig;
+	ETSParam par;
+} ETSEvent;
+
+typedef void (* ETSTask)(ETSEvent* e);
+
+#define os_signal_t			ETSSignal
+#define os_param_t			ETSParam
+#define os_event_t			ETSEvent
+#define os_task_t			ETSTask
+
+#endif /* HOST_INCLUDE_OS_TYPE_H_ */
@@ -0,0 +1,49 @@
+/*
+ * osapi.h
+ *
+ * Linux host build stand-in for the ESP8266 NON OS SDK OS API header.
+ */
+
+#ifndef HOST_INCLUDE_OSAPI_H_
+#define HOST_INCLUDE_OSAPI_H_
+
+#include <stdio.h>
+#include <string.h>
+
+#include "c_types.h"
+#include "os_type.h"
+#include "eagle_soc.h"
+#include "user_config.h"
+
+#define os_printf			os_printf_plus
+#define os_sprintf			sprintf
+#define os_snprintf			snprintf
+
+#define os_memcmp			memcmp
+#define os_memcpy			memcpy
+#define os_memmove			memmove
+#define os_memset			memset
+#define os_strcat			strcat
+#define os_strchr			strchr
+#define os_strcmp			strcmp
+#define os_strcpy			strcpy
+#define os_strlen			strlen
+#define os_strncmp			strncmp
+#define os_strncpy			strncpy
+#define os_strstr			strstr
+
+void os_timer_setfn(os_timer_t* ptimer, os_timer_func_t* pfunction, void* parg);
+void os_timer_arm(os_timer_t* ptimer, uint32 milliseconds, bool repeat_flag);
+void os_timer_disarm(os_timer_t* ptimer);
+
+void os_delay_us(uint32 us);
+unsigned long os_random(void);
+
+// UART driver initialization. Provided by driver_lib on target, no-op on host.
+void uart_init(uint32 uart0_br, uint32 uart1_br);
+
+// os_printf formats into character output routine installed by os_install_putc1 (stdout by default)
+int os_printf_plus(const char* format, ...) __attribute__((format(printf, 1, 2)));
+void os_install_putc1(void* p);
+
+#endif /* HOST_INCLUDE_OSAPI_H_ */
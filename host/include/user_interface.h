@@ -0,0 +1,225 @@
+/*
+ * user_interface.h
+ *
+ * Linux host build stand-in for the ESP8266 NON OS SDK system and WiFi API header.
+ */
+
+#ifndef HOST_INCLUDE_USER_INTERFACE_H_
+#define HOST_INCLUDE_USER_INTERFACE_H_
+
+#include <sys/queue.h>
+
+#include "c_types.h"
+#include "os_type.h"
+#include "ip_addr.h"
+
+typedef enum
+{
+	SYSTEM_PARTITION_INVALID = 0,
+	SYSTEM_PARTITION_BOOTLOADER,
+	SYSTEM_PARTITION_OTA_1,
+	SYSTEM_PARTITION_OTA_2,
+	SYSTEM_PARTITION_RF_CAL,
+	SYSTEM_PARTITION_PHY_DATA,
+	SYSTEM_PARTITION_SYSTEM_PARAMETER,
+	SYSTEM_PARTITION_AT_PARAMETER,
+	SYSTEM_PARTITION_SSL_CLIENT_CERT_PRIVKEY,
+	SYSTEM_PARTITION_SSL_CLIENT_CA,
+	SYSTEM_PARTITION_SSL_SERVER_CERT_PRIVKEY,
+	SYSTEM_PARTITION_SSL_SERVER_CA,
+	SYSTEM_PARTITION_WPA2_ENTERPRISE_CERT_PRIVKEY,
+	SYSTEM_PARTITION_WPA2_ENTERPRISE_CA,
+	SYSTEM_PARTITION_CUSTOMER_BEGIN = 100,
+	SYSTEM_PARTITION_MAX
+} partition_type_t;
+
+typedef struct
+{
+	partition_type_t type;
+	uint32_t addr;
+	uint32_t size;
+} partition_item_t;
+
+typedef void (* init_done_cb_t)(void);
+
+bool system_partition_table_regist(const partition_item_t* partition_table, uint32_t partition_num, uint32_t map);
+void system_init_done_cb(init_done_cb_t cb);
+uint32 system_get_time(void);
+uint32 system_get_free_heap_size(void);
+void system_restart(void);
+
+#define SYS_CPU_80MHZ		80
+#define SYS_CPU_160MHZ		160
+
+bool system_update_cpu_freq(uint8 freq);
+uint8 system_get_cpu_freq(void);
+
+enum
+{
+	USER_TASK_PRIO_0 = 0,
+	USER_TASK_PRIO_1,
+	USER_TASK_PRIO_2,
+	USER_TASK_PRIO_MAX
+};
+
+bool system_os_task(os_task_t task, uint8 prio, os_event_t* queue, uint8 qlen);
+bool system_os_post(uint8 prio, os_signal_t sig, os_param_t par);
+
+#define NULL_MODE			0x00
+#define STATION_MODE		0x01
+#define SOFTAP_MODE			0x02
+#define STATIONAP_MODE		0x03
+
+#define STATION_IF			0x00
+#define SOFTAP_IF			0x01
+
+typedef enum _auth_mode
+{
+	AUTH_OPEN = 0,
+	AUTH_WEP,
+	AUTH_WPA_PSK,
+	AUTH_WPA2_PSK,
+	AUTH_WPA_WPA2_PSK,
+	AUTH_MAX
+} AUTH_MODE;
+
+typedef enum _cipher_type
+{
+	CIPHER_NONE = 0,
+	CIPHER_WEP40,
+	CIPHER_WEP104,
+	CIPHER_TKIP,
+	CIPHER_CCMP,
+	CIPHER_TKIP_CCMP,
+	CIPHER_UNKNOWN,
+} CIPHER_TYPE;
+
+enum
+{
+	STATION_IDLE = 0,
+	STATION_CONNECTING,
+	STATION_WRONG_PASSWORD,
+	STATION_NO_AP_FOUND,
+	STATION_CONNECT_FAIL,
+	STATION_GOT_IP
+};
+
+struct softap_config
+{
+	uint8 ssid[32];
+	uint8 password[64];
+	uint8 ssid_len;
+	uint8 channel;
+	AUTH_MODE authmode;
+	uint8 ssid_hidden;
+	uint8 max_connection;
+	uint16 beacon_interval;
+};
+
+struct dhcps_lease
+{
+	bool enable;
+	struct ip_addr start_ip;
+	struct ip_addr end_ip;
+};
+
+struct bss_info
+{
+	STAILQ_ENTRY(bss_info) next;
+	uint8 bssid[6];
+	uint8 ssid[32];
+	uint8 ssid_len;
+	uint8 channel;
+	sint8 rssi;
+	AUTH_MODE authmode;
+	uint8 is_hidden;
+	sint16 freq_offset;
+	sint16 freqcal_val;
+	uint8* esp_mesh_ie;
+	uint8 simple_pair;
+};
+
+struct scan_config
+{
+	uint8* ssid;
+	uint8* bssid;
+	uint8 channel;
+	uint8 show_hidden;
+};
+
+// Scan results are passed as the first bss_info list entry (NULL if nothing was found)
+typedef void (* scan_done_cb_t)(void* arg, STATUS status);
+
+struct station_info
+{
+	STAILQ_ENTRY(station_info) next;
+	uint8 bssid[6];
+	struct ip_addr ip;
+};
+
+// WiFi events (station mode events are never raised by host build)
+enum
+{
+	EVENT_STAMODE_CONNECTED = 0,
+	EVENT_STAMODE_DISCONNECTED,
+	EVENT_STAMODE_AUTHMODE_CHANGE,
+	EVENT_STAMODE_GOT_IP,
+	EVENT_STAMODE_DHCP_TIMEOUT,
+	EVENT_SOFTAPMODE_STACONNECTED,
+	EVENT_SOFTAPMODE_STADISCONNECTED,
+	EVENT_SOFTAPMODE_PROBEREQRECVED,
+	EVENT_OPMODE_CHANGED,
+	EVENT_SOFTAPMODE_DISTRIBUTE_STA_IP,
+	EVENT_MAX
+};
+
+typedef struct
+{
+	uint8 mac[6];
+	uint8 aid;
+} Event_SoftAPMode_StaConnected_t;
+
+typedef struct
+{
+	uint8 mac[6];
+	uint8 aid;
+} Event_SoftAPMode_StaDisconnected_t;
+
+typedef struct
+{
+	int rssi;
+	uint8 mac[6];
+} Event_SoftAPMode_ProbeReqRecved_t;
+
+typedef union
+{
+	Event_SoftAPMode_StaConnected_t sta_connected;
+	Event_SoftAPMode_StaDisconnected_t sta_disconnected;
+	Event_SoftAPMode_ProbeReqRecved_t ap_probereqrecved;
+} Event_Info_u;
+
+typedef struct _esp_event
+{
+	uint32 event;
+	Event_Info_u event_info;
+} System_Event_t;
+
+typedef void (* wifi_event_handler_cb_t)(System_Event_t* event);
+
+bool wifi_set_opmode(uint8 opmode);
+bool wifi_set_opmode_current(uint8 opmode);
+bool wifi_station_scan(struct scan_config* config, scan_done_cb_t cb);
+uint8 wifi_get_opmode(void);
+bool wifi_set_ip_info(uint8 if_index, struct ip_info* info);
+bool wifi_get_ip_info(uint8 if_index, struct ip_info* info);
+bool wifi_softap_set_config(struct softap_config* config);
+bool wifi_softap_get_config(struct softap_config* config);
+uint8 wifi_softap_get_station_num(void);
+struct station_info* wifi_softap_get_station_info(void);
+void wifi_softap_free_station_info(void);
+void wifi_set_event_handler_cb(wifi_event_handler_cb_t cb);
+bool wifi_softap_dhcps_start(void);
+bool wifi_softap_dhcps_stop(void);
+bool wifi_softap_set_dhcps_lease(struct dhcps_lease* please);
+
+#endif /* HOST_INCLUDE_USER_INTERFACE_H_ */
@@ -0,0 +1,101 @@
+#include "host_shim.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Firmware entry points (user/user_main.c)
+void user_pre_init(void);
+void user_init(void);
+
+static void usage(const char* name)
+{
+	fprintf(stderr,
+		"Usage: %s [-o port_offset] [-s stations] [-H heap_bytes] [-t seconds] [-b rounds] [-S scan_file]\n"
+		"  -o  offset added to every listening port (default 0)\n"
+		"  -s  number of WiFi stations joining after boot (default 1),\n"
+		"      SIGUSR1 joins one more station, SIGUSR2 drops the most recently joined one\n"
+		"  -H  emulated device heap size in bytes (default %d)\n"
+		"  -t  stop after given number of seconds (default 0 - run forever)\n"
+		"  -b  run round-trip benchmark client for given number of rounds, then stop\n"
+		"  -S  WiFi scan results, one access point per line: channel rssi [ssid] (read on every scan)\n",
+		name, HOST_DEFAULT_HEAP_SIZE);
+}
+
+static int exit_code = 0;
+
+// Firmware starts its listener once boot channel scan completes, from a task posted by init done callback,
+// so benchmark client is started by a task queued after it
+static void start_bench(void* arg)
+{
+	if (host_bench_start() < 0)
+	{
+		exit_code = 1;
+		host_loop_stop();
+	}
+}
+
+static void on_signal(int signo)
+{
+	host_loop_stop();
+}
+
+int main(int argc, char** argv)
+{
+	int opt;
+	while ((opt = getopt(argc, argv, "o:s:H:t:b:S:h")) != -1)
+	{
+		switch (opt)
+		{
+			case 'o':
+				host_cfg.port_offset = atoi(optarg);
+				break;
+			case 's':
+				host_cfg.stations = (uint8)atoi(optarg);
+				break;
+			case 'H':
+				host_cfg.heap_size = (uint32)strtoul(optarg, NULL, 0);
+				break;
+			case 't':
+				host_cfg.run_seconds = (uint32)strtoul(optarg, NULL, 0);
+				break;
+			case 'b':
+				host_cfg.bench_rounds = (uint32)strtoul(optarg, NULL, 0);
+				break;
+			case 'S':
+				host_cfg.scan_file = optarg;
+				break;
+			default:
+				usage(argv[0]);
+				return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	struct sigaction sa;
+	sa.sa_handler = on_signal;
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = 0;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	// Benchmark client exit stops the loop
+	sigaction(SIGCHLD, &sa, NULL);
+	sa.sa_handler = host_wifi_signal;
+	sigaction(SIGUSR1, &sa, NULL);
+	sigaction(SIGUSR2, &sa, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	host_loop_init();
+	// Same boot sequence as on target: pre-init, init, then init done callback from the loop
+	user_pre_init();
+	user_init();
+	host_system_run_init_done();
+	if (host_cfg.bench_rounds)
+	{
+		host_loop_post(start_bench, NULL);
+	}
+	host_loop_run();
+
+	fprintf(stderr, "[HOST] Stopped. GPIO OUT register: 0x%08x\n", host_gpio_out());
+	return exit_code;
+}
@@ -0,0 +1,79 @@
+/*
+ * host_shim.h
+ *
+ * Internal interface of the Linux host shim. Maps ESP8266 NON OS SDK services
+ * to single-threaded epoll event loop, so SDK callbacks never run concurrently.
+ */
+
+#ifndef HOST_SHIM_HOST_SHIM_H_
+#define HOST_SHIM_HOST_SHIM_H_
+
+#include "c_types.h"
+#include "os_type.h"
+
+// Emulated device heap size available to os_malloc/os_zalloc (bytes)
+#define HOST_DEFAULT_HEAP_SIZE			40960
+// Maximum payload delivered to a single receive callback (emulates lwIP TCP MSS)
+#define HOST_TCP_MSS					1460
+
+typedef void (* host_task_fn)(void* arg);
+
+// Runtime options of host firmware image
+struct host_config
+{
+	// Offset added to every listening port (allows non-root runs, e.g. 1010 -> 11010)
+	int port_offset;
+	// Number of WiFi stations joining access point after boot
+	uint8 stations;
+	// Emulated device heap size
+	uint32 heap_size;
+	// Stops event loop after given number of seconds (0 - runs forever)
+	uint32 run_seconds;
+	// Number of request/reply rounds of round-trip benchmark (0 - benchmark disabled)
+	uint32 bench_rounds;
+	// File with canned WiFi scan results (NULL - scans find nothing)
+	const char* scan_file;
+};
+
+extern struct host_config host_cfg;
+
+// Event loop
+void host_loop_init(void);
+void host_loop_add(host_io_t* io, uint32 events);
+void host_loop_mod(host_io_t* io, uint32 events);
+void host_loop_del(host_io_t* io);
+void host_loop_post(host_task_fn fn, void* arg);
+void host_loop_run(void);
+void host_loop_stop(void);
+
+// Periodic housekeeping of espconn shim (idle timeouts)
+void host_espconn_poll(void);
+// Port of the first TCP listener (with port offset applied), 0 if none
+uint16 host_espconn_listener_port(void);
+
+// Round-trip benchmark client, runs in a child process against firmware listener
+int host_bench_start(void);
+
+// WiFi station emulation. SIGUSR1 joins one more station, SIGUSR2 drops the most recently joined one.
+#define HOST_MAX_STATIONS				8
+// Maximum number of access points reported by a single scan
+#define HOST_MAX_SCAN_RESULTS			32
+// Probe request is raised by one of connected stations every HOST_WIFI_PROBE_POLLS housekeeping polls
+#define HOST_WIFI_PROBE_POLLS			4
+// Records join or leave request, safe to call from signal handler
+void host_wifi_signal(int signo);
+// Delivers pending station events
+void host_wifi_poll(void);
+
+// Init done callback registered by firmware through system_init_done_cb
+void host_system_run_init_done(void);
+
+// Register file dump (used for exit report)
+uint32 host_gpio_out(void);
+
+// UART0 register block emulation
+#define HOST_UART0_BASEADDR				0x60000000
+#define HOST_UART_REGS_SIZE				0x80
+void host_uart_on_write(uint32 offset, uint32 value);
+
+#endif /* HOST_SHIM_HOST_SHIM_H_ */
@@ -0,0 +1,161 @@
+#include "host_shim.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cmd_frame.h"
+
+// Commands pipelined per round in a single write. Their replies take more than one firmware TX queue slot,
+// so the tail of the reply is sent while its head is still unacknowledged - the case delayed by Nagle algorithm.
+#define HOST_BENCH_BURST				32
+#define HOST_BENCH_CONNECT_ATTEMPTS		50
+
+static uint64 monotonic_us(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int compare_u32(const void* a, const void* b)
+{
+	uint32 x = *(const uint32*)a;
+	uint32 y = *(const uint32*)b;
+	return x < y ? -1 : x > y;
+}
+
+static int bench_connect(uint16 port)
+{
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	int attempt;
+	for (attempt = 0; attempt < HOST_BENCH_CONNECT_ATTEMPTS; ++attempt)
+	{
+		int fd = socket(AF_INET, SOCK_STREAM, 0);
+		if (fd < 0)
+		{
+			return -1;
+		}
+		if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0)
+		{
+			// Client side never delays its writes, only firmware socket profile is measured
+			int one = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+			return fd;
+		}
+		close(fd);
+		usleep(20000);
+	}
+	return -1;
+}
+
+// Reads until given number of reply frames is received
+static int bench_read_replies(int fd, uint8 replies)
+{
+	uint8 buf[CMD_FRAME_MAX_SZ * HOST_BENCH_BURST];
+	uint16 len = 0;
+	while (replies)
+	{
+		ssize_t n = recv(fd, buf + len, sizeof(buf) - len, 0);
+		if (n <= 0)
+		{
+			return -1;
+		}
+		len += (uint16)n;
+
+		struct cmd_frame frame;
+		uint16 consumed;
+		while (replies && cmd_frame_decode(buf, len, &frame, &consumed) == CMD_FRAME_DECODED)
+		{
+			memmove(buf, buf + consumed, len - consumed);
+			len -= consumed;
+			replies--;
+		}
+	}
+	return 0;
+}
+
+static int bench_run(uint16 port, uint32 rounds)
+{
+	int fd = bench_connect(port);
+	if (fd < 0)
+	{
+		perror("[BENCH] connect");
+		return 1;
+	}
+	uint32* rtt = malloc(rounds * sizeof(uint32));
+	if (!rtt)
+	{
+		close(fd);
+		return 1;
+	}
+
+	uint32 round;
+	for (round = 0; round < rounds; ++round)
+	{
+		uint8 burst[CMD_FRAME_MAX_SZ * HOST_BENCH_BURST];
+		uint16 len = 0;
+		uint8 idx;
+		for (idx = 0; idx < HOST_BENCH_BURST; ++idx)
+		{
+			uint8 op[CMD_OUTPUT_OP_SZ] = { CMD_OUTPUT_WRITE, (uint8)(round + idx) & 7 };
+			len += cmd_frame_encode(burst + len, CMD_OPCODE_OUTPUT_BATCH, (uint16)(round * HOST_BENCH_BURST + idx), op, sizeof(op));
+		}
+
+		uint64 started = monotonic_us();
+		if (send(fd, burst, len, 0) != len)
+		{
+			perror("[BENCH] send");
+			free(rtt);
+			close(fd);
+			return 1;
+		}
+		if (bench_read_replies(fd, HOST_BENCH_BURST) < 0)
+		{
+			fprintf(stderr, "[BENCH] Connection closed by server after %u rounds\n", round);
+			free(rtt);
+			close(fd);
+			return 1;
+		}
+		rtt[round] = (uint32)(monotonic_us() - started);
+	}
+	close(fd);
+
+	qsort(rtt, rounds, sizeof(uint32), compare_u32);
+	fprintf(stderr, "[BENCH] %u rounds of %d commands, round trip us: p50 %u, p99 %u, max %u\n",
+			rounds, HOST_BENCH_BURST, rtt[rounds / 2], rtt[(uint64)rounds * 99 / 100], rtt[rounds - 1]);
+	free(rtt);
+	return 0;
+}
+
+int host_bench_start(void)
+{
+	uint16 port = host_espconn_listener_port();
+	if (!port)
+	{
+		fprintf(stderr, "[BENCH] Firmware has no TCP listener\n");
+		return -1;
+	}
+	pid_t pid = fork();
+	if (pid < 0)
+	{
+		perror("[BENCH] fork");
+		return -1;
+	}
+	if (pid == 0)
+	{
+		_exit(bench_run(port, host_cfg.bench_rounds));
+	}
+	return 0;
+}
@@ -0,0 +1,716 @@
+#include "host_shim.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "espconn.h"
+#include "osapi.h"
+
+// Maximum number of listening espconn resources
+#define HOST_MAX_LISTENERS				4
+// Emulated lwIP send buffer size (TCP_SND_BUF = 2 * TCP_MSS)
+#define HOST_TCP_SND_BUF				(2 * HOST_TCP_MSS)
+// Marks espconn resources allocated by shim for accepted connections
+#define HOST_TCP_CONN_MAGIC				0x45535043
+// lwIP default limit of simultaneous TCP connections
+#define HOST_TCP_MAX_CON				5
+// Largest UDP payload fitting into single Ethernet frame
+#define HOST_UDP_MAX_PAYLOAD			1472
+
+struct host_listener
+{
+	host_io_t io;
+	struct espconn* pesp_conn;
+	// Idle timeout applied to accepted connections (seconds, 0 - disabled)
+	uint32 timeout;
+	// Maximum number of connections accepted by listener (0 - global limit applies)
+	uint8 max_con_allow;
+	uint8 connections;
+	// Sender of the last received datagram (UDP)
+	remot_info remote;
+};
+
+struct host_tcp_conn
+{
+	host_io_t io;
+	uint32 magic;
+	struct espconn conn;
+	esp_tcp tcp;
+	struct host_listener* listener;
+	struct host_tcp_conn* next;
+	uint32 last_activity;
+	bool closing;
+	bool tx_inflight;
+	uint16 tx_len;
+	uint16 tx_off;
+	uint8 tx_buf[HOST_TCP_SND_BUF];
+};
+
+static struct host_listener listeners[HOST_MAX_LISTENERS];
+static struct host_tcp_conn* connections = NULL;
+static uint8 tcp_max_con = HOST_TCP_MAX_CON;
+
+static uint32 monotonic_seconds(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32)ts.tv_sec;
+}
+
+static struct host_listener* find_listener(struct espconn* pesp_conn)
+{
+	uint8 idx;
+	for (idx = 0; idx < HOST_MAX_LISTENERS; ++idx)
+	{
+		if (listeners[idx].pesp_conn == pesp_conn)
+		{
+			return &listeners[idx];
+		}
+	}
+	return NULL;
+}
+
+static struct host_tcp_conn* find_connection(struct espconn* pesp_conn)
+{
+	struct host_tcp_conn* c = (struct host_tcp_conn*)((char*)pesp_conn - offsetof(struct host_tcp_conn, conn));
+	struct host_tcp_conn* it;
+	for (it = connections; it; it = it->next)
+	{
+		if (it == c && it->magic == HOST_TCP_CONN_MAGIC)
+		{
+			return it;
+		}
+	}
+	return NULL;
+}
+
+static void release_connection(struct host_tcp_conn* c)
+{
+	struct host_tcp_conn** it;
+	for (it = &connections; *it; it = &(*it)->next)
+	{
+		if (*it == c)
+		{
+			*it = c->next;
+			break;
+		}
+	}
+	host_loop_del(&c->io);
+	close(c->io.fd);
+	c->listener->connections--;
+	c->magic = 0;
+	free(c);
+}
+
+static void connection_events(struct host_tcp_conn* c)
+{
+	host_loop_mod(&c->io, EPOLLIN | EPOLLRDHUP | (c->tx_inflight ? EPOLLOUT : 0));
+}
+
+// Deferred graceful close: disconnect callback is triggered once the calling callback has returned
+static void close_task(void* arg)
+{
+	struct host_tcp_conn* c = (struct host_tcp_conn*)arg;
+	c->conn.state = ESPCONN_CLOSE;
+	if (c->tcp.disconnect_callback)
+	{
+		c->tcp.disconnect_callback(&c->conn);
+	}
+	release_connection(c);
+}
+
+// Graceful close sends FIN right away, abortive close leaves socket to be closed with zero linger (RST)
+static void schedule_close(struct host_tcp_conn* c, bool graceful)
+{
+	if (!c->closing)
+	{
+		c->closing = true;
+		host_loop_del(&c->io);
+		if (graceful)
+		{
+			shutdown(c->io.fd, SHUT_RDWR);
+		}
+		host_loop_post(close_task, c);
+	}
+}
+
+static void flush_tx(struct host_tcp_conn* c)
+{
+	while (c->tx_off < c->tx_len)
+	{
+		ssize_t n = send(c->io.fd, c->tx_buf + c->tx_off, c->tx_len - c->tx_off, MSG_NOSIGNAL);
+		if (n <= 0)
+		{
+			return;
+		}
+		c->tx_off += (uint16)n;
+	}
+}
+
+static void on_connection_event(host_io_t* io, uint32 events)
+{
+	struct host_tcp_conn* c = (struct host_tcp_conn*)io;
+	if (events & EPOLLOUT)
+	{
+		flush_tx(c);
+		if (c->tx_off == c->tx_len)
+		{
+			c->tx_inflight = false;
+			c->tx_len = c->tx_off = 0;
+			connection_events(c);
+			c->conn.state = ESPCONN_CONNECT;
+			if (c->conn.sent_callback)
+			{
+				c->conn.sent_callback(&c->conn);
+			}
+			if (c->closing)
+			{
+				return;
+			}
+		}
+	}
+	if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+	{
+		char buf[HOST_TCP_MSS];
+		ssize_t n = recv(c->io.fd, buf, sizeof(buf), 0);
+		if (n > 0)
+		{
+			c->last_activity = monotonic_seconds();
+			c->conn.state = ESPCONN_READ;
+			if (c->conn.recv_callback)
+			{
+				c->conn.recv_callback(&c->conn, buf, (unsigned short)n);
+			}
+			if (!c->closing)
+			{
+				c->conn.state = ESPCONN_CONNECT;
+			}
+		}
+		else if (n == 0)
+		{
+			c->conn.state = ESPCONN_CLOSE;
+			if (c->tcp.disconnect_callback)
+			{
+				c->tcp.disconnect_callback(&c->conn);
+			}
+			release_connection(c);
+		}
+		else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+		{
+			sint8 err = (errno == ECONNRESET) ? ESPCONN_RST : (errno == ETIMEDOUT) ? ESPCONN_TIMEOUT : ESPCONN_ABRT;
+			c->conn.state = ESPCONN_CLOSE;
+			if (c->tcp.reconnect_callback)
+			{
+				c->tcp.reconnect_callback(&c->conn, err);
+			}
+			release_connection(c);
+		}
+	}
+}
+
+static void on_listener_event(host_io_t* io, uint32 events)
+{
+	struct host_listener* l = (struct host_listener*)io;
+	struct sockaddr_in addr;
+	socklen_t addr_len = sizeof(addr);
+	int fd = accept4(io->fd, (struct sockaddr*)&addr, &addr_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if (fd < 0)
+	{
+		return;
+	}
+	// Connections over the limit are reset by lwIP without any callback
+	if (l->connections >= (l->max_con_allow ? l->max_con_allow : tcp_max_con))
+	{
+		struct linger lin = { 1, 0 };
+		setsockopt(fd, SOL_SOCKET, SO_LINGER, &lin, sizeof(lin));
+		close(fd);
+		fprintf(stderr, "[HOST] Connection limit reached, connection reset\n");
+		return;
+	}
+	l->connections++;
+
+	struct host_tcp_conn* c = (struct host_tcp_conn*)calloc(1, sizeof(struct host_tcp_conn));
+	c->io.fd = fd;
+	c->io.handler = on_connection_event;
+	c->magic = HOST_TCP_CONN_MAGIC;
+	c->listener = l;
+	c->last_activity = monotonic_seconds();
+
+	// Accepted connection inherits callbacks and user data from listening espconn
+	c->conn = *l->pesp_conn;
+	c->tcp = *l->pesp_conn->proto.tcp;
+	c->conn.proto.tcp = &c->tcp;
+	c->conn.state = ESPCONN_CONNECT;
+	os_memcpy(c->tcp.remote_ip, &addr.sin_addr.s_addr, 4);
+	c->tcp.remote_port = ntohs(addr.sin_port);
+	addr_len = sizeof(addr);
+	if (getsockname(fd, (struct sockaddr*)&addr, &addr_len) == 0)
+	{
+		os_memcpy(c->tcp.local_ip, &addr.sin_addr.s_addr, 4);
+	}
+
+	c->next = connections;
+	connections = c;
+	host_loop_add(&c->io, EPOLLIN | EPOLLRDHUP);
+
+	if (c->tcp.connect_callback)
+	{
+		c->tcp.connect_callback(&c->conn);
+	}
+}
+
+// Binds listening socket of given type to espconn local port (with port offset applied)
+static struct host_listener* open_listener(struct espconn* espconn, int local_port, void (* handler)(host_io_t* io, uint32 events))
+{
+	struct host_listener* l = find_listener(NULL);
+	struct sockaddr_in addr;
+	int one = 1;
+	if (!l)
+	{
+		return NULL;
+	}
+
+	int fd = socket(AF_INET, (espconn->type == ESPCONN_TCP ? SOCK_STREAM : SOCK_DGRAM) | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+	{
+		return NULL;
+	}
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	os_memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons((uint16)(local_port + host_cfg.port_offset));
+	if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || (espconn->type == ESPCONN_TCP && listen(fd, 16) < 0))
+	{
+		perror("[HOST] bind");
+		close(fd);
+		return NULL;
+	}
+
+	l->io.fd = fd;
+	l->io.handler = handler;
+	l->pesp_conn = espconn;
+	l->timeout = 0;
+	l->max_con_allow = 0;
+	l->connections = 0;
+	host_loop_add(&l->io, EPOLLIN);
+	return l;
+}
+
+sint8 espconn_accept(struct espconn* espconn)
+{
+	if (!espconn || espconn->type != ESPCONN_TCP || !espconn->proto.tcp)
+	{
+		return ESPCONN_ARG;
+	}
+	if (find_listener(espconn))
+	{
+		return ESPCONN_ISCONN;
+	}
+	if (!open_listener(espconn, espconn->proto.tcp->local_port, on_listener_event))
+	{
+		return ESPCONN_ISCONN;
+	}
+	espconn->state = ESPCONN_LISTEN;
+	fprintf(stderr, "[HOST] TCP listener on port %d\n", espconn->proto.tcp->local_port + host_cfg.port_offset);
+	return ESPCONN_OK;
+}
+
+// Every pending datagram is delivered to its own receive callback. As in SDK, proto.udp remote fields are left
+// as set by firmware (they are the send destination), sender is reported by espconn_get_connection_info only.
+static void on_udp_event(host_io_t* io, uint32 events)
+{
+	struct host_listener* l = (struct host_listener*)io;
+	uint8 buf[HOST_UDP_MAX_PAYLOAD];
+	for (;;)
+	{
+		struct sockaddr_in addr;
+		socklen_t addr_len = sizeof(addr);
+		ssize_t n = recvfrom(io->fd, buf, sizeof(buf), 0, (struct sockaddr*)&addr, &addr_len);
+		if (n < 0)
+		{
+			return;
+		}
+		struct espconn* espconn = l->pesp_conn;
+		os_memcpy(l->remote.remote_ip, &addr.sin_addr.s_addr, 4);
+		l->remote.remote_port = ntohs(addr.sin_port);
+		l->remote.state = ESPCONN_READ;
+		if (espconn->recv_callback)
+		{
+			espconn->recv_callback(espconn, (char*)buf, (unsigned short)n);
+		}
+		// Listener may be deleted from receive callback
+		if (l->pesp_conn != espconn)
+		{
+			return;
+		}
+	}
+}
+
+sint8 espconn_create(struct espconn* espconn)
+{
+	if (!espconn || espconn->type != ESPCONN_UDP || !espconn->proto.udp)
+	{
+		return ESPCONN_ARG;
+	}
+	if (find_listener(espconn))
+	{
+		return ESPCONN_ISCONN;
+	}
+	if (!open_listener(espconn, espconn->proto.udp->local_port, on_udp_event))
+	{
+		return ESPCONN_MEM;
+	}
+	fprintf(stderr, "[HOST] UDP listener on port %d\n", espconn->proto.udp->local_port + host_cfg.port_offset);
+	return ESPCONN_OK;
+}
+
+sint8 espconn_delete(struct espconn* espconn)
+{
+	struct host_listener* l = find_listener(espconn);
+	if (!l || !espconn)
+	{
+		return ESPCONN_ARG;
+	}
+	host_loop_del(&l->io);
+	close(l->io.fd);
+	l->pesp_conn = NULL;
+	espconn->state = ESPCONN_CLOSE;
+	return ESPCONN_OK;
+}
+
+sint8 espconn_disconnect(struct espconn* espconn)
+{
+	struct host_tcp_conn* c = find_connection(espconn);
+	if (!c || c->closing)
+	{
+		return ESPCONN_ARG;
+	}
+	schedule_close(c, true);
+	return ESPCONN_OK;
+}
+
+sint8 espconn_abort(struct espconn* espconn)
+{
+	struct host_tcp_conn* c = find_connection(espconn);
+	struct linger lin = { 1, 0 };
+	if (!c || c->closing)
+	{
+		return ESPCONN_ARG;
+	}
+	// Zero linger makes close() emit RST
+	setsockopt(c->io.fd, SOL_SOCKET, SO_LINGER, &lin, sizeof(lin));
+	schedule_close(c, false);
+	return ESPCONN_OK;
+}
+
+// Datagram is sent to remote address set in espconn proto.udp
+static sint8 send_datagram(struct espconn* espconn, uint8* psent, uint16 length)
+{
+	struct host_listener* l = find_listener(espconn);
+	if (!l || !psent || !length || length > HOST_UDP_MAX_PAYLOAD)
+	{
+		return ESPCONN_ARG;
+	}
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	os_memcpy(&addr.sin_addr.s_addr, espconn->proto.udp->remote_ip, 4);
+	addr.sin_port = htons(espconn->proto.udp->remote_port);
+	if (sendto(l->io.fd, psent, length, 0, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+	{
+		return ESPCONN_MEM;
+	}
+	return ESPCONN_OK;
+}
+
+// Only one buffer may be in flight per connection, next send is allowed after sent callback
+sint8 espconn_send(struct espconn* espconn, uint8* psent, uint16 length)
+{
+	if (espconn && espconn->type == ESPCONN_UDP)
+	{
+		return send_datagram(espconn, psent, length);
+	}
+	struct host_tcp_conn* c = find_connection(espconn);
+	if (!c || c->closing || !psent || !length || length > HOST_TCP_SND_BUF)
+	{
+		return ESPCONN_ARG;
+	}
+	if (c->tx_inflight)
+	{
+		return ESPCONN_MAXNUM;
+	}
+	os_memcpy(c->tx_buf, psent, length);
+	c->tx_len = length;
+	c->tx_off = 0;
+	c->tx_inflight = true;
+	c->conn.state = ESPCONN_WRITE;
+	flush_tx(c);
+	// Sent callback is always delivered from the loop, never from inside espconn_send
+	connection_events(c);
+	return ESPCONN_OK;
+}
+
+sint8 espconn_sent(struct espconn* espconn, uint8* psent, uint16 length)
+{
+	return espconn_send(espconn, psent, length);
+}
+
+// Reports remote end of accepted TCP connection or sender of datagram delivered to UDP listener.
+// Returned structure is owned by shim and stays valid until the next call or receive event.
+sint8 espconn_get_connection_info(struct espconn* pespconn, remot_info** pcon_info, uint8 typeflags)
+{
+	static remot_info tcp_remote;
+	struct host_listener* l;
+	struct host_tcp_conn* c;
+	if (!pespconn || !pcon_info)
+	{
+		return ESPCONN_ARG;
+	}
+	if (pespconn->type == ESPCONN_UDP && (l = find_listener(pespconn)))
+	{
+		*pcon_info = &l->remote;
+		return ESPCONN_OK;
+	}
+	if ((c = find_connection(pespconn)))
+	{
+		tcp_remote.state = c->conn.state;
+		tcp_remote.remote_port = c->tcp.remote_port;
+		os_memcpy(tcp_remote.remote_ip, c->tcp.remote_ip, sizeof(tcp_remote.remote_ip));
+		*pcon_info = &tcp_remote;
+		return ESPCONN_OK;
+	}
+	return ESPCONN_ARG;
+}
+
+uint8 espconn_tcp_get_max_con(void)
+{
+	return tcp_max_con;
+}
+
+sint8 espconn_tcp_set_max_con(uint8 num)
+{
+	if (!num)
+	{
+		return ESPCONN_ARG;
+	}
+	tcp_max_con = num;
+	return ESPCONN_OK;
+}
+
+sint8 espconn_tcp_get_max_con_allow(struct espconn* espconn)
+{
+	struct host_listener* l = espconn ? find_listener(espconn) : NULL;
+	if (!l)
+	{
+		return ESPCONN_ARG;
+	}
+	return l->max_con_allow ? l->max_con_allow : tcp_max_con;
+}
+
+sint8 espconn_tcp_set_max_con_allow(struct espconn* espconn, uint8 num)
+{
+	struct host_listener* l = espconn ? find_listener(espconn) : NULL;
+	if (!l || !num || num > tcp_max_con)
+	{
+		return ESPCONN_ARG;
+	}
+	l->max_con_allow = num;
+	return ESPCONN_OK;
+}
+
+// Socket options are mapped to their POSIX counterparts. ESPCONN_COPY has no host equivalent: data is always copied.
+sint8 espconn_set_opt(struct espconn* espconn, uint8 opt)
+{
+	struct host_tcp_conn* c = find_connection(espconn);
+	int one = 1;
+	if (!c)
+	{
+		return ESPCONN_ARG;
+	}
+	if (opt & ESPCONN_REUSEADDR)
+	{
+		setsockopt(c->io.fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	}
+	if (opt & ESPCONN_NODELAY)
+	{
+		setsockopt(c->io.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	}
+	if (opt & ESPCONN_KEEPALIVE)
+	{
+		setsockopt(c->io.fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+	}
+	return ESPCONN_OK;
+}
+
+sint8 espconn_clear_opt(struct espconn* espconn, uint8 opt)
+{
+	struct host_tcp_conn* c = find_connection(espconn);
+	int zero = 0;
+	if (!c)
+	{
+		return ESPCONN_ARG;
+	}
+	if (opt & ESPCONN_REUSEADDR)
+	{
+		setsockopt(c->io.fd, SOL_SOCKET, SO_REUSEADDR, &zero, sizeof(zero));
+	}
+	if (opt & ESPCONN_NODELAY)
+	{
+		setsockopt(c->io.fd, IPPROTO_TCP, TCP_NODELAY, &zero, sizeof(zero));
+	}
+	if (opt & ESPCONN_KEEPALIVE)
+	{
+		setsockopt(c->io.fd, SOL_SOCKET, SO_KEEPALIVE, &zero, sizeof(zero));
+	}
+	return ESPCONN_OK;
+}
+
+static int keepalive_sockopt(uint8 level)
+{
+	switch (level)
+	{
+		case ESPCONN_KEEPIDLE:
+			return TCP_KEEPIDLE;
+		case ESPCONN_KEEPINTVL:
+			return TCP_KEEPINTVL;
+		case ESPCONN_KEEPCNT:
+			return TCP_KEEPCNT;
+		default:
+			return -1;
+	}
+}
+
+sint8 espconn_set_keepalive(struct espconn* espconn, uint8 level, void* optarg)
+{
+	struct host_tcp_conn* c = find_connection(espconn);
+	int name = keepalive_sockopt(level);
+	int value;
+	if (!c || name < 0 || !optarg)
+	{
+		return ESPCONN_ARG;
+	}
+	value = (int)*(uint32*)optarg;
+	return setsockopt(c->io.fd, IPPROTO_TCP, name, &value, sizeof(value)) == 0 ? ESPCONN_OK : ESPCONN_ARG;
+}
+
+sint8 espconn_get_keepalive(struct espconn* espconn, uint8 level, void* optarg)
+{
+	struct host_tcp_conn* c = find_connection(espconn);
+	int name = keepalive_sockopt(level);
+	int value = 0;
+	socklen_t value_len = sizeof(value);
+	if (!c || name < 0 || !optarg)
+	{
+		return ESPCONN_ARG;
+	}
+	if (getsockopt(c->io.fd, IPPROTO_TCP, name, &value, &value_len) != 0)
+	{
+		return ESPCONN_ARG;
+	}
+	*(uint32*)optarg = (uint32)value;
+	return ESPCONN_OK;
+}
+
+sint8 espconn_regist_time(struct espconn* espconn, uint32 interval, uint8 type_flag)
+{
+	struct host_listener* l;
+	if (type_flag == 0)
+	{
+		l = find_listener(espconn);
+		if (!l)
+		{
+			return ESPCONN_ARG;
+		}
+		l->timeout = interval;
+		return ESPCONN_OK;
+	}
+	return find_connection(espconn) ? ESPCONN_OK : ESPCONN_ARG;
+}
+
+sint8 espconn_regist_connectcb(struct espconn* espconn, espconn_connect_callback connect_cb)
+{
+	if (!espconn || espconn->type != ESPCONN_TCP)
+	{
+		return ESPCONN_ARG;
+	}
+	espconn->proto.tcp->connect_callback = connect_cb;
+	return ESPCONN_OK;
+}
+
+sint8 espconn_regist_recvcb(struct espconn* espconn, espconn_recv_callback recv_cb)
+{
+	if (!espconn)
+	{
+		return ESPCONN_ARG;
+	}
+	espconn->recv_callback = recv_cb;
+	return ESPCONN_OK;
+}
+
+sint8 espconn_regist_sentcb(struct espconn* espconn, espconn_sent_callback sent_cb)
+{
+	if (!espconn)
+	{
+		return ESPCONN_ARG;
+	}
+	espconn->sent_callback = sent_cb;
+	return ESPCONN_OK;
+}
+
+sint8 espconn_regist_reconcb(struct espconn* espconn, espconn_reconnect_callback recon_cb)
+{
+	if (!espconn || espconn->type != ESPCONN_TCP)
+	{
+		return ESPCONN_ARG;
+	}
+	espconn->proto.tcp->reconnect_callback = recon_cb;
+	return ESPCONN_OK;
+}
+
+sint8 espconn_regist_disconcb(struct espconn* espconn, espconn_connect_callback discon_cb)
+{
+	if (!espconn || espconn->type != ESPCONN_TCP)
+	{
+		return ESPCONN_ARG;
+	}
+	espconn->proto.tcp->disconnect_callback = discon_cb;
+	return ESPCONN_OK;
+}
+
+uint16 host_espconn_listener_port(void)
+{
+	uint8 idx;
+	for (idx = 0; idx < HOST_MAX_LISTENERS; ++idx)
+	{
+		if (listeners[idx].pesp_conn && listeners[idx].pesp_conn->type == ESPCONN_TCP)
+		{
+			return (uint16)(listeners[idx].pesp_conn->proto.tcp->local_port + host_cfg.port_offset);
+		}
+	}
+	return 0;
+}
+
+// Closes accepted connections which stay idle longer than server timeout
+void host_espconn_poll(void)
+{
+	uint32 now = monotonic_seconds();
+	struct host_tcp_conn* c;
+	for (c = connections; c; c = c->next)
+	{
+		if (!c->closing && c->listener->timeout && now - c->last_activity >= c->listener->timeout)
+		{
+			fprintf(stderr, "[HOST] Connection idle timeout\n");
+			schedule_close(c, true);
+		}
+	}
+}
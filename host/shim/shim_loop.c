@@ -0,0 +1,137 @@
+#include "host_shim.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+// Maximum events handled per single epoll_wait call
+#define HOST_LOOP_MAX_EVENTS			64
+// Maximum number of deferred tasks pending between loop iterations
+#define HOST_LOOP_MAX_TASKS				256
+// Housekeeping interval (ms)
+#define HOST_LOOP_POLL_INTERVAL			250
+
+struct host_task
+{
+	host_task_fn fn;
+	void* arg;
+};
+
+static int epoll_fd = -1;
+static volatile int loop_running = 0;
+static struct host_task tasks[HOST_LOOP_MAX_TASKS];
+static uint32 tasks_head = 0;
+static uint32 tasks_tail = 0;
+
+void host_loop_init(void)
+{
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (epoll_fd < 0)
+	{
+		perror("[HOST] epoll_create1");
+		exit(1);
+	}
+}
+
+void host_loop_add(host_io_t* io, uint32 events)
+{
+	struct epoll_event ev;
+	ev.events = events;
+	ev.data.ptr = io;
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, io->fd, &ev) < 0)
+	{
+		perror("[HOST] epoll_ctl(ADD)");
+	}
+}
+
+void host_loop_mod(host_io_t* io, uint32 events)
+{
+	struct epoll_event ev;
+	ev.events = events;
+	ev.data.ptr = io;
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, io->fd, &ev) < 0)
+	{
+		perror("[HOST] epoll_ctl(MOD)");
+	}
+}
+
+void host_loop_del(host_io_t* io)
+{
+	epoll_ctl(epoll_fd, EPOLL_CTL_DEL, io->fd, NULL);
+}
+
+// Defers task execution to the end of current loop iteration (SDK never re-enters callbacks)
+void host_loop_post(host_task_fn fn, void* arg)
+{
+	if (tasks_tail - tasks_head >= HOST_LOOP_MAX_TASKS)
+	{
+		fprintf(stderr, "[HOST] Deferred tasks queue overflow\n");
+		abort();
+	}
+	tasks[tasks_tail % HOST_LOOP_MAX_TASKS].fn = fn;
+	tasks[tasks_tail % HOST_LOOP_MAX_TASKS].arg = arg;
+	tasks_tail++;
+}
+
+static void run_tasks(void)
+{
+	while (tasks_head != tasks_tail)
+	{
+		struct host_task task = tasks[tasks_head % HOST_LOOP_MAX_TASKS];
+		tasks_head++;
+		task.fn(task.arg);
+	}
+}
+
+static uint64 monotonic_ms(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void host_loop_run(void)
+{
+	struct epoll_event events[HOST_LOOP_MAX_EVENTS];
+	uint64 started = monotonic_ms();
+	uint64 last_poll = started;
+	loop_running = 1;
+	run_tasks();
+	while (loop_running)
+	{
+		int n = epoll_wait(epoll_fd, events, HOST_LOOP_MAX_EVENTS, HOST_LOOP_POLL_INTERVAL);
+		if (n < 0 && errno != EINTR)
+		{
+			perror("[HOST] epoll_wait");
+			break;
+		}
+		int i;
+		for (i = 0; i < n; ++i)
+		{
+			host_io_t* io = (host_io_t*)events[i].data.ptr;
+			io->handler(io, events[i].events);
+		}
+		// Deferred tasks may release sockets, so these run only after the whole batch is dispatched
+		run_tasks();
+		uint64 now = monotonic_ms();
+		if (now - last_poll >= HOST_LOOP_POLL_INTERVAL)
+		{
+			last_poll = now;
+			host_espconn_poll();
+			host_wifi_poll();
+			run_tasks();
+		}
+		if (host_cfg.run_seconds && now - started >= (uint64)host_cfg.run_seconds * 1000)
+		{
+			loop_running = 0;
+		}
+	}
+}
+
+void host_loop_stop(void)
+{
+	loop_running = 0;
+}
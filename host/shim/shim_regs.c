@@ -0,0 +1,55 @@
+#include "host_shim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gpio.h"
+
+// In-memory peripheral register file covering HOST_PERI_BASEADDR..HOST_PERI_BASEADDR + HOST_PERI_SIZE
+static volatile uint32 peri_regs[HOST_PERI_SIZE / sizeof(uint32)];
+
+volatile uint32* host_peri_reg(uint32 addr)
+{
+	if (addr < HOST_PERI_BASEADDR || addr >= HOST_PERI_BASEADDR + HOST_PERI_SIZE || (addr & 0x03))
+	{
+		fprintf(stderr, "[HOST] Invalid peripheral register access: 0x%08x\n", addr);
+		abort();
+	}
+	return &peri_regs[(addr - HOST_PERI_BASEADDR) / sizeof(uint32)];
+}
+
+// UART0 registers are handled by UART emulation after being stored
+void host_peri_write(uint32 addr, uint32 value)
+{
+	*host_peri_reg(addr) = value;
+	if (addr < HOST_UART0_BASEADDR + HOST_UART_REGS_SIZE)
+	{
+		host_uart_on_write(addr - HOST_UART0_BASEADDR, value);
+	}
+}
+
+void gpio_init(void)
+{
+}
+
+// Mirrors ROM implementation: writes go through W1TS/W1TC registers, which update OUT/ENABLE registers
+void gpio_output_set(uint32 set_mask, uint32 clear_mask, uint32 enable_mask, uint32 disable_mask)
+{
+	GPIO_REG_WRITE(GPIO_OUT_W1TS_ADDRESS, set_mask);
+	GPIO_REG_WRITE(GPIO_OUT_W1TC_ADDRESS, clear_mask);
+	GPIO_REG_WRITE(GPIO_ENABLE_W1TS_ADDRESS, enable_mask);
+	GPIO_REG_WRITE(GPIO_ENABLE_W1TC_ADDRESS, disable_mask);
+	GPIO_REG_WRITE(GPIO_OUT_ADDRESS, (GPIO_REG_READ(GPIO_OUT_ADDRESS) | set_mask) & ~clear_mask);
+	GPIO_REG_WRITE(GPIO_ENABLE_ADDRESS, (GPIO_REG_READ(GPIO_ENABLE_ADDRESS) | enable_mask) & ~disable_mask);
+}
+
+// Output pins are looped back to inputs
+uint32 gpio_input_get(void)
+{
+	return GPIO_REG_READ(GPIO_OUT_ADDRESS);
+}
+
+uint32 host_gpio_out(void)
+{
+	return GPIO_REG_READ(GPIO_OUT_ADDRESS);
+}
@@ -0,0 +1,463 @@
+#include "host_shim.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mem.h"
+#include "osapi.h"
+#include "user_interface.h"
+
+// Allocation header keeping block size for heap accounting
+struct host_block
+{
+	size_t size;
+	char payload[] __attribute__((aligned(16)));
+};
+
+struct host_config host_cfg =
+{
+	0,
+	1,
+	HOST_DEFAULT_HEAP_SIZE,
+	0,
+	0,
+	NULL
+};
+
+static uint32 heap_used = 0;
+static init_done_cb_t init_done_cb = NULL;
+static uint8 opmode = NULL_MODE;
+static uint8 cpu_freq = SYS_CPU_80MHZ;
+static struct ip_info if_ip_info[2];
+static struct softap_config ap_config;
+static struct dhcps_lease dhcp_lease;
+static wifi_event_handler_cb_t wifi_event_cb = NULL;
+// Emulated stations, kept in join order. Station MAC is 02:48:53:54:00:<aid>.
+static struct station_info stations[HOST_MAX_STATIONS];
+static uint8 station_aids[HOST_MAX_STATIONS];
+static uint8 station_count = 0;
+static STAILQ_HEAD(, station_info) station_list;
+// Station joins and leaves requested by signals, served by host_wifi_poll
+static volatile sig_atomic_t station_joins = 0;
+static volatile sig_atomic_t station_leaves = 0;
+static uint32 wifi_polls = 0;
+// Canned scan results loaded from host_cfg.scan_file
+static struct bss_info scan_results[HOST_MAX_SCAN_RESULTS];
+static STAILQ_HEAD(, bss_info) scan_list;
+static scan_done_cb_t scan_done_cb = NULL;
+
+// User task with its event queue, events are delivered from event loop once the posting callback has returned
+struct host_os_task
+{
+	os_task_t task;
+	os_event_t* queue;
+	uint8 qlen;
+	uint8 head;
+	uint8 count;
+};
+
+static struct host_os_task os_tasks[USER_TASK_PRIO_MAX];
+
+void* host_malloc(size_t size, bool zero)
+{
+	struct host_block* block;
+	if (heap_used + size > host_cfg.heap_size)
+	{
+		return NULL;
+	}
+	block = zero ? calloc(1, sizeof(struct host_block) + size) : malloc(sizeof(struct host_block) + size);
+	if (!block)
+	{
+		return NULL;
+	}
+	block->size = size;
+	heap_used += size;
+	return block->payload;
+}
+
+void host_free(void* ptr)
+{
+	if (ptr)
+	{
+		struct host_block* block = (struct host_block*)((char*)ptr - sizeof(struct host_block));
+		heap_used -= block->size;
+		free(block);
+	}
+}
+
+uint32 system_get_free_heap_size(void)
+{
+	return host_cfg.heap_size - heap_used;
+}
+
+// Microseconds since start, wraps around every ~71 minutes as SDK counter does
+// System time counts from the first call (made during firmware init), as on target it counts from boot
+uint32 system_get_time(void)
+{
+	static uint64 boot_us = 0;
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	uint64 now = (uint64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+	if (!boot_us)
+	{
+		boot_us = now;
+	}
+	return (uint32)(now - boot_us);
+}
+
+void system_restart(void)
+{
+	fprintf(stderr, "[HOST] system_restart requested\n");
+	host_loop_stop();
+}
+
+// CPU clock has no effect on host, so only the setting itself is kept
+bool system_update_cpu_freq(uint8 freq)
+{
+	if (freq != SYS_CPU_80MHZ && freq != SYS_CPU_160MHZ)
+	{
+		return false;
+	}
+	cpu_freq = freq;
+	return true;
+}
+
+uint8 system_get_cpu_freq(void)
+{
+	return cpu_freq;
+}
+
+bool system_os_task(os_task_t task, uint8 prio, os_event_t* queue, uint8 qlen)
+{
+	if (prio >= USER_TASK_PRIO_MAX || !task || !queue || !qlen || os_tasks[prio].task)
+	{
+		return false;
+	}
+	os_tasks[prio].task = task;
+	os_tasks[prio].queue = queue;
+	os_tasks[prio].qlen = qlen;
+	return true;
+}
+
+static void run_os_task(void* arg)
+{
+	struct host_os_task* t = (struct host_os_task*)arg;
+	os_event_t event = t->queue[t->head];
+	t->head = (t->head + 1) % t->qlen;
+	t->count--;
+	t->task(&event);
+}
+
+// As in SDK, post fails once task queue is full
+bool system_os_post(uint8 prio, os_signal_t sig, os_param_t par)
+{
+	struct host_os_task* t = prio < USER_TASK_PRIO_MAX ? &os_tasks[prio] : NULL;
+	if (!t || !t->task || t->count >= t->qlen)
+	{
+		return false;
+	}
+	t->queue[(t->head + t->count) % t->qlen].sig = sig;
+	t->queue[(t->head + t->count) % t->qlen].par = par;
+	t->count++;
+	host_loop_post(run_os_task, t);
+	return true;
+}
+
+bool system_partition_table_regist(const partition_item_t* partition_table, uint32_t partition_num, uint32_t map)
+{
+	return partition_table != NULL && partition_num > 0;
+}
+
+void system_init_done_cb(init_done_cb_t cb)
+{
+	init_done_cb = cb;
+}
+
+void host_system_run_init_done(void)
+{
+	if (init_done_cb)
+	{
+		init_done_cb();
+	}
+}
+
+unsigned long os_random(void)
+{
+	return (unsigned long)random();
+}
+
+bool wifi_set_opmode(uint8 mode)
+{
+	opmode = mode;
+	return true;
+}
+
+bool wifi_set_opmode_current(uint8 mode)
+{
+	opmode = mode;
+	return true;
+}
+
+// Loads scan results file: one access point per line as "channel rssi [ssid]", '#' starts a comment
+static void load_scan_results(void)
+{
+	char line[128];
+	uint8 count = 0;
+	STAILQ_INIT(&scan_list);
+	FILE* file = host_cfg.scan_file ? fopen(host_cfg.scan_file, "r") : NULL;
+	if (host_cfg.scan_file && !file)
+	{
+		perror("[HOST] Scan results file");
+	}
+	while (file && count < HOST_MAX_SCAN_RESULTS && fgets(line, sizeof(line), file))
+	{
+		struct bss_info* bss = &scan_results[count];
+		int channel;
+		int rssi;
+		char ssid[33] = "";
+		if (line[0] == '#' || sscanf(line, "%d %d %32s", &channel, &rssi, ssid) < 2)
+		{
+			continue;
+		}
+		memset(bss, 0, sizeof(struct bss_info));
+		bss->channel = (uint8)channel;
+		bss->rssi = (sint8)rssi;
+		bss->ssid_len = (uint8)strlen(ssid);
+		memcpy(bss->ssid, ssid, bss->ssid_len);
+		bss->bssid[0] = 0x02;
+		bss->bssid[5] = count;
+		STAILQ_INSERT_TAIL(&scan_list, bss, next);
+		count++;
+	}
+	if (file)
+	{
+		fclose(file);
+	}
+}
+
+static void finish_scan(void* arg)
+{
+	scan_done_cb_t cb = scan_done_cb;
+	scan_done_cb = NULL;
+	load_scan_results();
+	cb(STAILQ_FIRST(&scan_list), OK);
+}
+
+// Scan completes right away with results of scan file (nothing is found without it)
+bool wifi_station_scan(struct scan_config* config, scan_done_cb_t cb)
+{
+	if (!(opmode & STATION_MODE) || scan_done_cb || !cb)
+	{
+		return false;
+	}
+	scan_done_cb = cb;
+	host_loop_post(finish_scan, NULL);
+	return true;
+}
+
+uint8 wifi_get_opmode(void)
+{
+	return opmode;
+}
+
+bool wifi_set_ip_info(uint8 if_index, struct ip_info* info)
+{
+	if (if_index > SOFTAP_IF)
+	{
+		return false;
+	}
+	if_ip_info[if_index] = *info;
+	return true;
+}
+
+bool wifi_get_ip_info(uint8 if_index, struct ip_info* info)
+{
+	if (if_index > SOFTAP_IF)
+	{
+		return false;
+	}
+	*info = if_ip_info[if_index];
+	return true;
+}
+
+// Initial stations join once access point configuration (and IP setup following it) is done
+static void join_initial_stations(void* arg)
+{
+	station_joins = host_cfg.stations;
+	host_wifi_poll();
+}
+
+bool wifi_softap_set_config(struct softap_config* config)
+{
+	static bool configured = false;
+	if (opmode != SOFTAP_MODE && opmode != STATIONAP_MODE)
+	{
+		return false;
+	}
+	ap_config = *config;
+	if (!configured)
+	{
+		configured = true;
+		host_loop_post(join_initial_stations, NULL);
+	}
+	return true;
+}
+
+bool wifi_softap_get_config(struct softap_config* config)
+{
+	*config = ap_config;
+	return true;
+}
+
+uint8 wifi_softap_get_station_num(void)
+{
+	return station_count;
+}
+
+struct station_info* wifi_softap_get_station_info(void)
+{
+	uint8 idx;
+	STAILQ_INIT(&station_list);
+	for (idx = 0; idx < station_count; ++idx)
+	{
+		STAILQ_INSERT_TAIL(&station_list, &stations[idx], next);
+	}
+	return STAILQ_FIRST(&station_list);
+}
+
+void wifi_softap_free_station_info(void)
+{
+	STAILQ_INIT(&station_list);
+}
+
+void wifi_set_event_handler_cb(wifi_event_handler_cb_t cb)
+{
+	wifi_event_cb = cb;
+}
+
+// Event handler runs as a separate task, as SDK raises WiFi events from its own task
+static void deliver_wifi_event(void* arg)
+{
+	System_Event_t* event = arg;
+	if (wifi_event_cb)
+	{
+		wifi_event_cb(event);
+	}
+	free(event);
+}
+
+static void post_wifi_event(uint32 id, uint8 index)
+{
+	System_Event_t* event = calloc(1, sizeof(System_Event_t));
+	if (!event)
+	{
+		return;
+	}
+	event->event = id;
+	switch (id)
+	{
+		case EVENT_SOFTAPMODE_STACONNECTED:
+			memcpy(event->event_info.sta_connected.mac, stations[index].bssid, 6);
+			event->event_info.sta_connected.aid = station_aids[index];
+			break;
+		case EVENT_SOFTAPMODE_STADISCONNECTED:
+			memcpy(event->event_info.sta_disconnected.mac, stations[index].bssid, 6);
+			event->event_info.sta_disconnected.aid = station_aids[index];
+			break;
+		case EVENT_SOFTAPMODE_PROBEREQRECVED:
+			memcpy(event->event_info.ap_probereqrecved.mac, stations[index].bssid, 6);
+			event->event_info.ap_probereqrecved.rssi = -40;
+			break;
+	}
+	host_loop_post(deliver_wifi_event, event);
+}
+
+// Joins station with the lowest free association id, unless access point is full
+static void station_join(void)
+{
+	uint8 aid;
+	uint8 idx;
+	if (station_count >= ap_config.max_connection || station_count >= HOST_MAX_STATIONS)
+	{
+		fprintf(stderr, "[HOST] Station join refused, %d stations connected\n", station_count);
+		return;
+	}
+	for (aid = 1; ; ++aid)
+	{
+		for (idx = 0; idx < station_count && station_aids[idx] != aid; ++idx)
+		{
+		}
+		if (idx == station_count)
+		{
+			break;
+		}
+	}
+	struct station_info* info = &stations[station_count];
+	static const uint8 mac_prefix[5] = { 0x02, 0x48, 0x53, 0x54, 0x00 };
+	memcpy(info->bssid, mac_prefix, sizeof(mac_prefix));
+	info->bssid[5] = aid;
+	info->ip.addr = if_ip_info[SOFTAP_IF].ip.addr + ((uint32)aid << 24);
+	station_aids[station_count] = aid;
+	post_wifi_event(EVENT_SOFTAPMODE_STACONNECTED, station_count);
+	station_count++;
+}
+
+// Drops the most recently joined station
+static void station_leave(void)
+{
+	if (station_count)
+	{
+		post_wifi_event(EVENT_SOFTAPMODE_STADISCONNECTED, station_count - 1);
+		station_count--;
+	}
+}
+
+void host_wifi_signal(int signo)
+{
+	if (signo == SIGUSR1)
+	{
+		station_joins++;
+	}
+	else
+	{
+		station_leaves++;
+	}
+}
+
+void host_wifi_poll(void)
+{
+	while (station_joins > 0)
+	{
+		station_joins--;
+		station_join();
+	}
+	while (station_leaves > 0)
+	{
+		station_leaves--;
+		station_leave();
+	}
+	// Connected stations take turns sending probe requests
+	if (station_count && ++wifi_polls % HOST_WIFI_PROBE_POLLS == 0)
+	{
+		post_wifi_event(EVENT_SOFTAPMODE_PROBEREQRECVED, (wifi_polls / HOST_WIFI_PROBE_POLLS) % station_count);
+	}
+}
+
+bool wifi_softap_dhcps_start(void)
+{
+	return true;
+}
+
+bool wifi_softap_dhcps_stop(void)
+{
+	return true;
+}
+
+bool wifi_softap_set_dhcps_lease(struct dhcps_lease* please)
+{
+	dhcp_lease = *please;
+	return true;
+}
@@ -0,0 +1,91 @@
+#include "host_shim.h"
+
+#include <stdio.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "osapi.h"
+
+static void on_timerfd_event(host_io_t* io, uint32 events)
+{
+	os_timer_t* ptimer = (os_timer_t*)io;
+	uint64 expirations;
+	if (read(io->fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+	{
+		return;
+	}
+	// ETS timers fire late rather than catching up, so a single invocation is made regardless of overruns
+	if (ptimer->timer_func)
+	{
+		ptimer->timer_func(ptimer->timer_arg);
+	}
+}
+
+static void timer_create_fd(os_timer_t* ptimer)
+{
+	if (!ptimer->timer_created)
+	{
+		ptimer->io.fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+		if (ptimer->io.fd < 0)
+		{
+			perror("[HOST] timerfd_create");
+			return;
+		}
+		ptimer->io.handler = on_timerfd_event;
+		host_loop_add(&ptimer->io, EPOLLIN);
+		ptimer->timer_created = true;
+	}
+}
+
+void os_timer_setfn(os_timer_t* ptimer, os_timer_func_t* pfunction, void* parg)
+{
+	os_timer_disarm(ptimer);
+	ptimer->timer_func = pfunction;
+	ptimer->timer_arg = parg;
+}
+
+void os_timer_arm(os_timer_t* ptimer, uint32 milliseconds, bool repeat_flag)
+{
+	struct itimerspec spec;
+	timer_create_fd(ptimer);
+	if (!ptimer->timer_created)
+	{
+		return;
+	}
+	// Zero delay would disarm timerfd, while ETS timer fires as soon as possible
+	if (milliseconds == 0)
+	{
+		spec.it_value.tv_sec = 0;
+		spec.it_value.tv_nsec = 1;
+	}
+	else
+	{
+		spec.it_value.tv_sec = milliseconds / 1000;
+		spec.it_value.tv_nsec = (milliseconds % 1000) * 1000000L;
+	}
+	spec.it_interval.tv_sec = repeat_flag ? milliseconds / 1000 : 0;
+	spec.it_interval.tv_nsec = repeat_flag ? (milliseconds % 1000) * 1000000L : 0;
+	ptimer->timer_period = repeat_flag ? milliseconds : 0;
+	timerfd_settime(ptimer->io.fd, 0, &spec, NULL);
+}
+
+void os_timer_disarm(os_timer_t* ptimer)
+{
+	struct itimerspec spec;
+	if (ptimer->timer_created)
+	{
+		os_memset(&spec, 0, sizeof(spec));
+		timerfd_settime(ptimer->io.fd, 0, &spec, NULL);
+	}
+	ptimer->timer_period = 0;
+}
+
+void os_delay_us(uint32 us)
+{
+	struct timespec ts;
+	ts.tv_sec = us / 1000000;
+	ts.tv_nsec = (us % 1000000) * 1000L;
+	nanosleep(&ts, NULL);
+}
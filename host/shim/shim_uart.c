@@ -0,0 +1,139 @@
+#include "host_shim.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "ets_sys.h"
+#include "osapi.h"
+
+// UART0 register offsets and interrupt bits (see ESP8266 Technical Reference, UART registers)
+#define UART_FIFO_OFFSET				0x00
+#define UART_INT_RAW_OFFSET				0x04
+#define UART_INT_ST_OFFSET				0x08
+#define UART_INT_ENA_OFFSET				0x0C
+#define UART_INT_CLR_OFFSET				0x10
+#define UART_TXFIFO_EMPTY_INT			BIT(1)
+// Largest single os_printf output
+#define HOST_PRINTF_BUF_SZ				1024
+
+static void (* putc1)(char c) = NULL;
+static ets_isr_t uart_isr = NULL;
+static void* uart_isr_arg = NULL;
+static bool uart_intr_unmasked = false;
+static bool uart_intr_pending = false;
+
+static volatile uint32* uart_reg(uint32 offset)
+{
+	return host_peri_reg(HOST_UART0_BASEADDR + offset);
+}
+
+// Interrupt is delivered from the loop after current callback returns: interrupt handler never runs nested
+// in firmware code on host, while on target it may preempt it at any point
+static void uart_interrupt_task(void* arg)
+{
+	uart_intr_pending = false;
+	// Transmitted bytes reach stdout right away, so TX FIFO is always empty
+	*uart_reg(UART_INT_RAW_OFFSET) |= UART_TXFIFO_EMPTY_INT;
+	*uart_reg(UART_INT_ST_OFFSET) = *uart_reg(UART_INT_RAW_OFFSET) & *uart_reg(UART_INT_ENA_OFFSET);
+	if (uart_isr && uart_intr_unmasked && *uart_reg(UART_INT_ST_OFFSET))
+	{
+		uart_isr(uart_isr_arg);
+		// Level-triggered: handler which keeps interrupt enabled is called again
+		if (*uart_reg(UART_INT_ENA_OFFSET) & UART_TXFIFO_EMPTY_INT)
+		{
+			uart_intr_pending = true;
+			host_loop_post(uart_interrupt_task, NULL);
+		}
+	}
+}
+
+static void raise_uart_interrupt(void)
+{
+	if (!uart_intr_pending && uart_isr && uart_intr_unmasked && (*uart_reg(UART_INT_ENA_OFFSET) & UART_TXFIFO_EMPTY_INT))
+	{
+		uart_intr_pending = true;
+		host_loop_post(uart_interrupt_task, NULL);
+	}
+}
+
+void host_uart_on_write(uint32 offset, uint32 value)
+{
+	switch (offset)
+	{
+		case UART_FIFO_OFFSET:
+			putchar((int)(value & 0xFF));
+			if ((value & 0xFF) == '\n')
+			{
+				fflush(stdout);
+			}
+			break;
+		case UART_INT_ENA_OFFSET:
+			raise_uart_interrupt();
+			break;
+		case UART_INT_CLR_OFFSET:
+			*uart_reg(UART_INT_RAW_OFFSET) &= ~value;
+			*uart_reg(UART_INT_ST_OFFSET) &= ~value;
+			*uart_reg(UART_INT_CLR_OFFSET) = 0;
+			break;
+	}
+}
+
+void uart_init(uint32 uart0_br, uint32 uart1_br)
+{
+	setvbuf(stdout, NULL, _IOLBF, 0);
+}
+
+void ets_isr_attach(int inum, ets_isr_t handler, void* arg)
+{
+	if (inum == ETS_UART_INUM)
+	{
+		uart_isr = handler;
+		uart_isr_arg = arg;
+	}
+}
+
+void ets_isr_mask(uint32 mask)
+{
+	if (mask & (1 << ETS_UART_INUM))
+	{
+		uart_intr_unmasked = false;
+	}
+}
+
+void ets_isr_unmask(uint32 mask)
+{
+	if (mask & (1 << ETS_UART_INUM))
+	{
+		uart_intr_unmasked = true;
+		raise_uart_interrupt();
+	}
+}
+
+void os_install_putc1(void* p)
+{
+	putc1 = (void (*)(char))p;
+}
+
+int os_printf_plus(const char* format, ...)
+{
+	char buf[HOST_PRINTF_BUF_SZ];
+	va_list args;
+	va_start(args, format);
+	int length = vsnprintf(buf, sizeof(buf), format, args);
+	va_end(args);
+	if (length >= (int)sizeof(buf))
+	{
+		length = sizeof(buf) - 1;
+	}
+	if (!putc1)
+	{
+		fwrite(buf, 1, length, stdout);
+		return length;
+	}
+	int idx;
+	for (idx = 0; idx < length; ++idx)
+	{
+		putc1(buf[idx]);
+	}
+	return length;
+}
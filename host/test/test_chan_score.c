@@ -0,0 +1,92 @@
+/*
+ * Channel scoring test: canned scan of a crowded site (tools/scan_crowded.txt) is scored by firmware channel
+ * scoring (utils/chan_score.c) and access point counts, scores and selected channel are checked against
+ * values worked out by hand. Channels 5 and 13 tie, so the tie-break rules are checked as well.
+ *
+ * Usage: test_chan_score [scan_file]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "chan_score.h"
+#include "chan_select.h"
+
+#define SCAN_FILE_DEFAULT					"tools/scan_crowded.txt"
+
+static const uint8 expected_aps[CHAN_SCORE_CHANNELS] = { 3, 0, 1, 0, 0, 3, 0, 0, 1, 2, 3, 0, 1 };
+static const uint16 expected_scores[CHAN_SCORE_CHANNELS] =
+		{ 155, 127, 131, 118, 107, 136, 128, 157, 185, 211, 212, 160, 107 };
+
+// Selected channel for preferred channel: boot scan default, the other of tied channels, no preference
+static const uint8 expected_best[][2] =
+{
+	{ CHAN_SELECT_DEFAULT, 5 },
+	{ 13, 13 },
+	{ 0, 5 },
+};
+
+// Same format chan_score tool reads: channel rssi [ssid], '#' starts a comment
+static bool load_scan(const char* path, struct chan_score* score)
+{
+	char line[128];
+	FILE* file = fopen(path, "r");
+	if (!file)
+	{
+		perror(path);
+		return false;
+	}
+	chan_score_reset(score);
+	while (fgets(line, sizeof(line), file))
+	{
+		int channel;
+		int rssi;
+		if (line[0] != '#' && sscanf(line, "%d %d", &channel, &rssi) == 2)
+		{
+			chan_score_add(score, (uint8)channel, (sint8)rssi);
+		}
+	}
+	fclose(file);
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	const char* path = argc > 1 ? argv[1] : SCAN_FILE_DEFAULT;
+	struct chan_score score;
+	bool passed = true;
+	uint8 channel;
+	size_t idx;
+
+	if (!load_scan(path, &score))
+	{
+		return 1;
+	}
+	for (channel = 1; channel <= CHAN_SCORE_CHANNELS; ++channel)
+	{
+		if (score.aps[channel - 1] != expected_aps[channel - 1]
+				|| chan_score_get(&score, channel) != expected_scores[channel - 1])
+		{
+			fprintf(stderr, "FAIL: channel %d: %d APs, score %d, expected %d APs, score %d\n", channel,
+					score.aps[channel - 1], chan_score_get(&score, channel),
+					expected_aps[channel - 1], expected_scores[channel - 1]);
+			passed = false;
+		}
+	}
+	for (idx = 0; idx < sizeof(expected_best) / sizeof(expected_best[0]); ++idx)
+	{
+		uint8 best = chan_score_best(&score, expected_best[idx][0]);
+		if (best != expected_best[idx][1])
+		{
+			fprintf(stderr, "FAIL: preferred channel %d: selected %d, expected %d\n",
+					expected_best[idx][0], best, expected_best[idx][1]);
+			passed = false;
+		}
+	}
+	if (!passed)
+	{
+		return 1;
+	}
+	printf("PASS: %s, channel %d selected\n", path, chan_score_best(&score, CHAN_SELECT_DEFAULT));
+	return 0;
+}
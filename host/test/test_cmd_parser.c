@@ -0,0 +1,283 @@
+/*
+ * Segmentation test of command parser: one generated byte stream of digit commands, binary frames
+ * (valid and corrupted) and filler bytes is fed to cmd_parser_next whole and split at random points.
+ * Every run has to produce the same sequence of commands, matching the one the stream was built from.
+ *
+ * Usage: test_cmd_parser [rounds] [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cmd_parser.h"
+
+#define STREAM_MAX_SZ						16384
+#define EVENTS_MAX							4096
+// Stream items generated per round
+#define STREAM_ITEMS						200
+
+// Command reported by parser, frame payload is copied
+struct test_event
+{
+	uint8 result;
+	char digit;
+	uint8 opcode;
+	uint16 seq;
+	uint8 length;
+	uint8 payload[CMD_FRAME_MAX_PAYLOAD];
+};
+
+struct test_run
+{
+	struct test_event events[EVENTS_MAX];
+	uint16 count;
+	uint32 ignored;
+	// Parser returned without consuming anything while input remained, receive loop would spin forever
+	bool stalled;
+};
+
+static uint8 stream[STREAM_MAX_SZ];
+static uint16 stream_sz;
+static struct test_run expected;
+static struct test_run actual;
+
+static struct test_event* add_event(struct test_run* run, uint8 result)
+{
+	struct test_event* event = &run->events[run->count++];
+	memset(event, 0, sizeof(struct test_event));
+	event->result = result;
+	return event;
+}
+
+// Filler byte which is neither digit command nor frame magic
+static uint8 filler_byte(void)
+{
+	for (;;)
+	{
+		uint8 value = rand() & 0xFF;
+		if ((value < CMD_PARSER_DIGITS_START || value > CMD_PARSER_DIGITS_END) && value != CMD_FRAME_MAGIC)
+		{
+			return value;
+		}
+	}
+}
+
+// Frame payload may contain any byte, digits and magic included
+static void append_frame(bool corrupt)
+{
+	uint8 payload[CMD_FRAME_MAX_PAYLOAD];
+	uint8 length = rand() % (CMD_FRAME_MAX_PAYLOAD + 1);
+	uint8 opcode = 1 + rand() % CMD_OPCODE_CHANNEL_QUERY;
+	uint16 seq = rand() & 0xFFFF;
+	uint16 frame_sz;
+	uint8 idx;
+	for (idx = 0; idx < length; ++idx)
+	{
+		payload[idx] = rand() % 4 ? rand() & 0xFF : (rand() % 2 ? CMD_FRAME_MAGIC : '0' + rand() % 8);
+	}
+	frame_sz = cmd_frame_encode(stream + stream_sz, opcode, seq, payload, length);
+	if (corrupt)
+	{
+		stream[stream_sz + frame_sz - 1] ^= 1 << (rand() % 8);
+		add_event(&expected, CMD_PARSER_ERROR);
+	}
+	else
+	{
+		struct test_event* event = add_event(&expected, CMD_PARSER_FRAME);
+		event->opcode = opcode;
+		event->seq = seq;
+		event->length = length;
+		memcpy(event->payload, payload, length);
+	}
+	stream_sz += frame_sz;
+}
+
+static void build_stream(void)
+{
+	uint16 item;
+	stream_sz = 0;
+	memset(&expected, 0, sizeof(expected));
+	for (item = 0; item < STREAM_ITEMS; ++item)
+	{
+		int kind = rand() % 10;
+		if (kind < 4)
+		{
+			// Digit run
+			uint8 count = 1 + rand() % 8;
+			while (count--)
+			{
+				char digit = CMD_PARSER_DIGITS_START + rand() % (CMD_PARSER_DIGITS_END - CMD_PARSER_DIGITS_START + 1);
+				stream[stream_sz++] = digit;
+				add_event(&expected, CMD_PARSER_DIGIT)->digit = digit;
+			}
+		}
+		else if (kind < 7)
+		{
+			// Filler long enough to take word-at-a-time scanning path
+			uint8 count = 1 + rand() % 40;
+			expected.ignored += count;
+			while (count--)
+			{
+				stream[stream_sz++] = filler_byte();
+			}
+		}
+		else if (kind < 9)
+		{
+			append_frame(false);
+		}
+		else if (rand() % 2)
+		{
+			append_frame(true);
+		}
+		else
+		{
+			// Header with out of range length field is dropped alone
+			stream[stream_sz++] = CMD_FRAME_MAGIC;
+			stream[stream_sz++] = CMD_OPCODE_STATE_QUERY;
+			stream[stream_sz++] = rand() & 0xFF;
+			stream[stream_sz++] = rand() & 0xFF;
+			stream[stream_sz++] = CMD_FRAME_MAX_PAYLOAD + 1 + rand() % (0xFF - CMD_FRAME_MAX_PAYLOAD);
+			add_event(&expected, CMD_PARSER_ERROR);
+		}
+	}
+}
+
+// Feeds stream split at given points (ascending, within stream) to a fresh parser.
+// Each segment is copied to its own buffer, as receive callback data does not outlive the callback.
+static void replay(const uint16* splits, uint16 splits_count)
+{
+	static uint8 segment[STREAM_MAX_SZ];
+	struct cmd_parser parser;
+	struct cmd_parser_command command;
+	uint16 start = 0;
+	uint16 idx;
+
+	memset(&actual, 0, sizeof(actual));
+	cmd_parser_reset(&parser);
+	for (idx = 0; idx <= splits_count; ++idx)
+	{
+		uint16 end = idx < splits_count ? splits[idx] : stream_sz;
+		uint16 length = end - start;
+		uint16 offset = 0;
+		memcpy(segment, stream + start, length);
+		while (offset < length)
+		{
+			uint16 consumed;
+			uint8 res = cmd_parser_next(&parser, segment + offset, length - offset, &consumed, &command);
+			if (!consumed)
+			{
+				actual.stalled = true;
+				return;
+			}
+			offset += consumed;
+			actual.ignored += command.ignored;
+			if (res == CMD_PARSER_DIGIT)
+			{
+				add_event(&actual, res)->digit = command.digit;
+			}
+			else if (res == CMD_PARSER_FRAME)
+			{
+				struct test_event* event = add_event(&actual, res);
+				event->opcode = command.frame.opcode;
+				event->seq = command.frame.seq;
+				event->length = command.frame.length;
+				memcpy(event->payload, command.frame.payload, command.frame.length);
+			}
+			else if (res == CMD_PARSER_ERROR)
+			{
+				add_event(&actual, res);
+			}
+		}
+		start = end;
+	}
+}
+
+// Returns index of the first mismatching event, -1 if runs match
+static int compare_runs(void)
+{
+	uint16 idx;
+	for (idx = 0; idx < expected.count && idx < actual.count; ++idx)
+	{
+		const struct test_event* a = &expected.events[idx];
+		const struct test_event* b = &actual.events[idx];
+		if (a->result != b->result || a->digit != b->digit || a->opcode != b->opcode || a->seq != b->seq
+				|| a->length != b->length || memcmp(a->payload, b->payload, a->length))
+		{
+			return idx;
+		}
+	}
+	return expected.count == actual.count ? -1 : idx;
+}
+
+static int compare_uint16(const void* a, const void* b)
+{
+	return *(const uint16*)a - *(const uint16*)b;
+}
+
+static bool check(const char* mode, int round, uint16 splits_count)
+{
+	int mismatch = compare_runs();
+	if (actual.stalled)
+	{
+		fprintf(stderr, "FAIL: round %d, %s, %d splits: parser made no progress after %d commands\n",
+				round, mode, splits_count, actual.count);
+		return false;
+	}
+	if (mismatch >= 0 || actual.ignored != expected.ignored)
+	{
+		fprintf(stderr, "FAIL: round %d, %s, %d splits: %d/%d commands, first mismatch at %d, %u/%u bytes ignored\n",
+				round, mode, splits_count, actual.count, expected.count, mismatch, actual.ignored, expected.ignored);
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	static uint16 splits[STREAM_MAX_SZ];
+	int rounds = argc > 1 ? atoi(argv[1]) : 200;
+	unsigned seed = argc > 2 ? strtoul(argv[2], NULL, 0) : 1;
+	uint32 commands = 0;
+	int round;
+
+	srand(seed);
+	for (round = 0; round < rounds; ++round)
+	{
+		uint16 splits_count;
+		uint16 idx;
+
+		build_stream();
+		commands += expected.count;
+		// Whole stream in one segment
+		replay(NULL, 0);
+		if (!check("whole", round, 0))
+		{
+			return 1;
+		}
+		// Every byte in its own segment
+		for (idx = 0; idx + 1 < stream_sz; ++idx)
+		{
+			splits[idx] = idx + 1;
+		}
+		replay(splits, stream_sz - 1);
+		if (!check("bytewise", round, stream_sz - 1))
+		{
+			return 1;
+		}
+		// Random split points, duplicates give empty segments
+		splits_count = rand() % (stream_sz / 4 + 1);
+		for (idx = 0; idx < splits_count; ++idx)
+		{
+			splits[idx] = rand() % (stream_sz + 1);
+		}
+		qsort(splits, splits_count, sizeof(uint16), compare_uint16);
+		replay(splits, splits_count);
+		if (!check("random", round, splits_count))
+		{
+			return 1;
+		}
+	}
+	printf("PASS: %d rounds, %u commands, seed %u\n", rounds, commands, seed);
+	return 0;
+}
@@ -0,0 +1,61 @@
+/*
+ * Scores access point channels from canned WiFi scan results with firmware channel scoring
+ * (utils/chan_score.c), the same way boot scan does.
+ *
+ * Usage: chan_score [-c current_channel] [scan_file]
+ * Scan file holds one access point per line: channel rssi [ssid], '#' starts a comment.
+ * Results are read from stdin if no file is given.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "chan_score.h"
+
+int main(int argc, char** argv)
+{
+	struct chan_score score;
+	uint8 current = 0;
+	char line[128];
+	int opt;
+	while ((opt = getopt(argc, argv, "c:h")) != -1)
+	{
+		switch (opt)
+		{
+			case 'c':
+				current = (uint8)atoi(optarg);
+				break;
+			default:
+				fprintf(stderr, "Usage: %s [-c current_channel] [scan_file]\n", argv[0]);
+				return opt == 'h' ? 0 : 1;
+		}
+	}
+	FILE* file = optind < argc ? fopen(argv[optind], "r") : stdin;
+	if (!file)
+	{
+		perror(argv[optind]);
+		return 1;
+	}
+
+	chan_score_reset(&score);
+	while (fgets(line, sizeof(line), file))
+	{
+		int channel;
+		int rssi;
+		if (line[0] != '#' && sscanf(line, "%d %d", &channel, &rssi) == 2)
+		{
+			chan_score_add(&score, (uint8)channel, (sint8)rssi);
+		}
+	}
+
+	uint8 best = chan_score_best(&score, current);
+	uint8 channel;
+	printf("channel  APs  score\n");
+	for (channel = 1; channel <= CHAN_SCORE_CHANNELS; ++channel)
+	{
+		printf("%7d  %3d  %5d%s\n", channel, score.aps[channel - 1], chan_score_get(&score, channel),
+				channel == best ? "  <- selected" : channel == current ? "  <- current" : "");
+	}
+	return 0;
+}
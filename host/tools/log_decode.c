@@ -0,0 +1,230 @@
+/*
+ * Decodes binary log stream (UART_BINARY_LOGS, see include/log_binary.h) back to text using
+ * dictionary extracted by log_dict. Bytes outside of binary records (SDK and boot messages)
+ * are passed through unchanged.
+ *
+ * Usage: log_decode log_dict.txt [stream] (stream defaults to stdin)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log_binary.h"
+
+#define MAX_LINE_SZ							1024
+#define MAX_SPEC_SZ							32
+
+static char* formats[1 << 16];
+
+// Converts C string literal notation back to characters
+static char* unescape(const char* src)
+{
+	char* out = malloc(strlen(src) + 1);
+	char* dst = out;
+	while (*src)
+	{
+		if (*src != '\\')
+		{
+			*dst++ = *src++;
+			continue;
+		}
+		src++;
+		switch (*src)
+		{
+			case 'n':
+				*dst++ = '\n';
+				src++;
+				break;
+			case 'r':
+				*dst++ = '\r';
+				src++;
+				break;
+			case 't':
+				*dst++ = '\t';
+				src++;
+				break;
+			case 'x':
+				*dst++ = (char)strtoul(src + 1, (char**)&src, 16);
+				break;
+			case 0:
+				break;
+			default:
+				*dst++ = *src++;
+				break;
+		}
+	}
+	*dst = 0;
+	return out;
+}
+
+static int load_dictionary(const char* path)
+{
+	FILE* file = fopen(path, "r");
+	if (!file)
+	{
+		return -1;
+	}
+	char line[MAX_LINE_SZ];
+	while (fgets(line, sizeof(line), file))
+	{
+		char* tab = strchr(line, '\t');
+		if (line[0] == '#' || !tab)
+		{
+			continue;
+		}
+		line[strcspn(line, "\n")] = 0;
+		unsigned long id = strtoul(line, NULL, 0);
+		if (id < sizeof(formats) / sizeof(formats[0]))
+		{
+			free(formats[id]);
+			formats[id] = unescape(tab + 1);
+		}
+	}
+	fclose(file);
+	return 0;
+}
+
+static const uint8* get_varint(const uint8* pos, const uint8* end, uint32* value)
+{
+	uint8 shift = 0;
+	*value = 0;
+	while (pos < end && shift < 35)
+	{
+		uint8 byte = *pos++;
+		*value |= (uint32)(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+		{
+			return pos;
+		}
+		shift += 7;
+	}
+	return NULL;
+}
+
+// Prints record with its format, arguments are taken from payload in conversion order
+static void print_record(const char* format, const uint8* payload, uint8 length)
+{
+	const uint8* pos = payload;
+	const uint8* end = payload + length;
+	while (*format)
+	{
+		if (*format != '%')
+		{
+			putchar(*format++);
+			continue;
+		}
+		// Conversion spec without length modifiers: every numeric argument is a 32-bit word
+		char spec[MAX_SPEC_SZ];
+		size_t spec_len = 0;
+		spec[spec_len++] = *format++;
+		while (*format && strchr("-+ #0123456789.hlz", *format))
+		{
+			if (!strchr("hlz", *format) && spec_len < MAX_SPEC_SZ - 2)
+			{
+				spec[spec_len++] = *format;
+			}
+			format++;
+		}
+		char conversion = *format;
+		if (!conversion)
+		{
+			break;
+		}
+		format++;
+		if (conversion == '%')
+		{
+			putchar('%');
+			continue;
+		}
+		spec[spec_len++] = conversion;
+		spec[spec_len] = 0;
+		uint32 value;
+		pos = pos ? get_varint(pos, end, &value) : NULL;
+		if (!pos)
+		{
+			fputs("<?>", stdout);
+		}
+		else if (conversion == 's')
+		{
+			uint32 str_len = value <= (uint32)(end - pos) ? value : (uint32)(end - pos);
+			printf("%.*s", (int)str_len, (const char*)pos);
+			pos += str_len;
+		}
+		else if (conversion == 'd' || conversion == 'i' || conversion == 'c')
+		{
+			printf(spec, (int)value);
+		}
+		else if (conversion == 'p')
+		{
+			printf("0x%08x", value);
+		}
+		else
+		{
+			printf(spec, (unsigned)value);
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2 || argc > 3)
+	{
+		fprintf(stderr, "Usage: %s log_dict.txt [stream]\n", argv[0]);
+		return 2;
+	}
+	if (load_dictionary(argv[1]))
+	{
+		fprintf(stderr, "Unable to read dictionary %s\n", argv[1]);
+		return 1;
+	}
+	FILE* stream = argc == 3 ? fopen(argv[2], "rb") : stdin;
+	if (!stream)
+	{
+		fprintf(stderr, "Unable to open %s\n", argv[2]);
+		return 1;
+	}
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	// Bytes read ahead while checking record header are re-scanned if it turns out to be text
+	uint8 pending[LOG_BINARY_HEADER_SZ];
+	int pending_num = 0;
+	for (;;)
+	{
+		int c = pending_num ? pending[--pending_num] : getc(stream);
+		if (c == EOF)
+		{
+			break;
+		}
+		if (c != LOG_BINARY_MARKER)
+		{
+			putchar(c);
+			continue;
+		}
+		uint8 header[LOG_BINARY_HEADER_SZ - 1];
+		int header_len;
+		for (header_len = 0; header_len < (int)sizeof(header); ++header_len)
+		{
+			int next = pending_num ? pending[--pending_num] : getc(stream);
+			if (next == EOF)
+			{
+				break;
+			}
+			header[header_len] = (uint8)next;
+		}
+		uint16 id = header[0] | (header[1] << 8);
+		if (header_len < (int)sizeof(header) || !formats[id])
+		{
+			putchar(c);
+			while (header_len)
+			{
+				pending[pending_num++] = header[--header_len];
+			}
+			continue;
+		}
+		uint8 payload[LOG_BINARY_PAYLOAD_MAX];
+		size_t length = fread(payload, 1, header[2], stream);
+		print_record(formats[id], payload, (uint8)length);
+	}
+	return 0;
+}
@@ -0,0 +1,184 @@
+/*
+ * Extracts binary log dictionary from firmware sources preprocessed with -DLOG_DICT_EXTRACT
+ * (see OS_UART_LOG in include/mod_enums.h): one "id<TAB>format" line per log call site,
+ * format is kept in C string literal notation.
+ *
+ * Usage: log_dict file.i... > log_dict.txt
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log_binary.h"
+
+#define ENTRY_TAG							"LOG_DICT_ENTRY"
+#define END_TAG								"LOG_DICT_END"
+#define MAX_ENTRIES							2048
+#define MAX_FORMAT_SZ						512
+
+struct dict_entry
+{
+	uint16 id;
+	char format[MAX_FORMAT_SZ];
+};
+
+static struct dict_entry entries[MAX_ENTRIES];
+static int entries_num = 0;
+
+static char* read_file(const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	if (!file)
+	{
+		return NULL;
+	}
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	char* text = malloc(size + 1);
+	if (text && fread(text, 1, size, file) != (size_t)size)
+	{
+		free(text);
+		text = NULL;
+	}
+	if (text)
+	{
+		text[size] = 0;
+	}
+	fclose(file);
+	return text;
+}
+
+// Concatenates adjacent string literals up to END_TAG, escape sequences are copied as is
+static const char* parse_format(const char* pos, char* format, const char* path)
+{
+	size_t length = 0;
+	for (;;)
+	{
+		while (isspace((unsigned char)*pos))
+		{
+			pos++;
+		}
+		if (!strncmp(pos, END_TAG, strlen(END_TAG)))
+		{
+			format[length] = 0;
+			return pos + strlen(END_TAG);
+		}
+		if (*pos != '"')
+		{
+			fprintf(stderr, "%s: log format is not a string literal\n", path);
+			return NULL;
+		}
+		for (pos++; *pos && *pos != '"'; pos++)
+		{
+			if (length + 2 >= MAX_FORMAT_SZ)
+			{
+				fprintf(stderr, "%s: log format is too long\n", path);
+				return NULL;
+			}
+			if (*pos == '\\')
+			{
+				format[length++] = *pos++;
+			}
+			format[length++] = *pos;
+		}
+		if (*pos != '"')
+		{
+			fprintf(stderr, "%s: unterminated log format\n", path);
+			return NULL;
+		}
+		pos++;
+	}
+}
+
+// The same call site is seen by each file including it, different formats with the same id are an error
+static int add_entry(uint16 id, const char* format, const char* path)
+{
+	int idx;
+	for (idx = 0; idx < entries_num; ++idx)
+	{
+		if (entries[idx].id == id)
+		{
+			if (strcmp(entries[idx].format, format))
+			{
+				fprintf(stderr, "%s: log id 0x%04x is used by two call sites\n", path, id);
+				return -1;
+			}
+			return 0;
+		}
+	}
+	if (entries_num == MAX_ENTRIES)
+	{
+		fprintf(stderr, "Too many log call sites\n");
+		return -1;
+	}
+	entries[entries_num].id = id;
+	strcpy(entries[entries_num].format, format);
+	entries_num++;
+	return 0;
+}
+
+static int extract(const char* path)
+{
+	char* text = read_file(path);
+	if (!text)
+	{
+		fprintf(stderr, "Unable to read %s\n", path);
+		return -1;
+	}
+	const char* pos = text;
+	int res = 0;
+	while (!res && (pos = strstr(pos, ENTRY_TAG)) != NULL)
+	{
+		char* end;
+		pos += strlen(ENTRY_TAG);
+		unsigned long module = strtoul(pos, &end, 0);
+		unsigned long line = strtoul(end, &end, 0);
+		char format[MAX_FORMAT_SZ];
+		if (line >> LOG_BINARY_LINE_BITS || module >> (16 - LOG_BINARY_LINE_BITS))
+		{
+			fprintf(stderr, "%s:%lu: log call site does not fit into log id\n", path, line);
+			res = -1;
+		}
+		else if ((pos = parse_format(end, format, path)) == NULL)
+		{
+			res = -1;
+		}
+		else
+		{
+			res = add_entry(LOG_BINARY_ID(module, line), format, path);
+		}
+	}
+	free(text);
+	return res;
+}
+
+static int compare_entries(const void* a, const void* b)
+{
+	return (int)((const struct dict_entry*)a)->id - (int)((const struct dict_entry*)b)->id;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s file.i... > log_dict.txt\n", argv[0]);
+		return 2;
+	}
+	int idx;
+	for (idx = 1; idx < argc; ++idx)
+	{
+		if (extract(argv[idx]))
+		{
+			return 1;
+		}
+	}
+	qsort(entries, entries_num, sizeof(entries[0]), compare_entries);
+	for (idx = 0; idx < entries_num; ++idx)
+	{
+		printf("0x%04x\t%s\n", entries[idx].id, entries[idx].format);
+	}
+	return 0;
+}
@@ -0,0 +1,224 @@
+/*
+ * Fetches trace ring dump from running firmware (CMD_OPCODE_TRACE_DUMP pages over TCP)
+ * and converts it to Chrome trace event JSON, viewable in chrome://tracing or ui.perfetto.dev.
+ *
+ * Usage: trace_to_chrome [-p port] host > trace.json
+ */
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "cmd_frame.h"
+#include "trace_ring.h"
+
+#define DEFAULT_PORT						"1010"
+#define MAX_PAGES							256
+
+static const char* event_name(uint8 event)
+{
+	switch (event & ~TRACE_EVENT_END)
+	{
+		case TRACE_EV_TIMER:
+			return "timer";
+		case TRACE_EV_ACCEPT:
+			return "tcp accept";
+		case TRACE_EV_RECV:
+			return "tcp receive";
+		case TRACE_EV_UDP_RECV:
+			return "udp receive";
+		case TRACE_EV_DIGIT:
+			return "digit applied";
+		case TRACE_EV_DISCONNECT:
+			return "disconnect";
+		case TRACE_EV_RECONNECT:
+			return "reconnect error";
+		default:
+			return "unknown";
+	}
+}
+
+static bool is_span(uint8 event)
+{
+	switch (event & ~TRACE_EVENT_END)
+	{
+		case TRACE_EV_TIMER:
+		case TRACE_EV_ACCEPT:
+		case TRACE_EV_RECV:
+		case TRACE_EV_UDP_RECV:
+			return true;
+		default:
+			return false;
+	}
+}
+
+static int connect_to(const char* host, const char* port)
+{
+	struct addrinfo hints;
+	struct addrinfo* res;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	if (getaddrinfo(host, port, &hints, &res))
+	{
+		return -1;
+	}
+	int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+	if (fd >= 0 && connect(fd, res->ai_addr, res->ai_addrlen) < 0)
+	{
+		close(fd);
+		fd = -1;
+	}
+	freeaddrinfo(res);
+	return fd;
+}
+
+// Sends trace dump request for given page and waits for its reply frame
+static int request_page(int fd, uint8 page, uint8* reply, struct cmd_frame* frame)
+{
+	uint8 request[CMD_FRAME_MAX_SZ];
+	uint16 length = cmd_frame_encode(request, CMD_OPCODE_TRACE_DUMP, page, &page, 1);
+	if (send(fd, request, length, 0) != length)
+	{
+		return -1;
+	}
+	uint16 received = 0;
+	for (;;)
+	{
+		uint16 consumed;
+		uint8 res = cmd_frame_decode(reply, received, frame, &consumed);
+		if (res == CMD_FRAME_DECODED && frame->opcode == (CMD_OPCODE_TRACE_DUMP | CMD_OPCODE_REPLY) && frame->seq == page)
+		{
+			return 0;
+		}
+		if (res != CMD_FRAME_INCOMPLETE)
+		{
+			return -1;
+		}
+		ssize_t n = recv(fd, reply + received, CMD_FRAME_MAX_SZ - received, 0);
+		if (n <= 0)
+		{
+			return -1;
+		}
+		received += (uint16)n;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const char* port = DEFAULT_PORT;
+	int opt;
+	while ((opt = getopt(argc, argv, "p:h")) != -1)
+	{
+		if (opt == 'p')
+		{
+			port = optarg;
+		}
+		else
+		{
+			fprintf(stderr, "Usage: %s [-p port] host > trace.json\n", argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+	if (optind >= argc)
+	{
+		fprintf(stderr, "Usage: %s [-p port] host > trace.json\n", argv[0]);
+		return 1;
+	}
+	int fd = connect_to(argv[optind], port);
+	if (fd < 0)
+	{
+		fprintf(stderr, "Unable to connect to %s:%s\n", argv[optind], port);
+		return 1;
+	}
+
+	static struct trace_record records[MAX_PAGES * CMD_TRACE_PAGE_RECORDS];
+	uint32 count = 0;
+	uint32 expected_seq = 0;
+	uint8 pages = 1;
+	uint8 page;
+	for (page = 0; page < pages; ++page)
+	{
+		uint8 reply[CMD_FRAME_MAX_SZ];
+		struct cmd_frame frame;
+		if (request_page(fd, page, reply, &frame) < 0 || frame.length < CMD_TRACE_HEADER_SZ)
+		{
+			fprintf(stderr, "Trace dump request failed at page %d\n", page);
+			close(fd);
+			return 1;
+		}
+		const uint8* p = frame.payload;
+		if (p[0] != CMD_STATUS_OK)
+		{
+			fprintf(stderr, "Trace dump page %d failed with status %d\n", page, p[0]);
+			close(fd);
+			return 1;
+		}
+		pages = p[2];
+		uint8 n = p[3];
+		uint32 first = p[4] | (p[5] << 8) | (p[6] << 16) | ((uint32)p[7] << 24);
+		if (page && first != expected_seq)
+		{
+			fprintf(stderr, "Trace dump page %d is out of sequence\n", page);
+		}
+		expected_seq = first + n;
+		p += CMD_TRACE_HEADER_SZ;
+		uint8 idx;
+		for (idx = 0; idx < n; ++idx, p += TRACE_RECORD_SZ)
+		{
+			struct trace_record* record = &records[count++];
+			record->time = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32)p[3] << 24);
+			record->event = p[4];
+			record->arg0 = p[5];
+			record->arg1 = p[6] | (p[7] << 8);
+		}
+	}
+	close(fd);
+
+	// system_get_time wraps around every ~71 minutes, timestamps are unwrapped relative to the first record.
+	// All callbacks run on the single SDK task, so everything is placed on one track.
+	printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	uint64 ts = count ? records[0].time : 0;
+	bool open_span[TRACE_EVENT_END] = { false };
+	bool first_event = true;
+	uint32 idx;
+	for (idx = 0; idx < count; ++idx)
+	{
+		const struct trace_record* record = &records[idx];
+		if (idx)
+		{
+			ts += (uint32)(record->time - records[idx - 1].time);
+		}
+		uint8 id = record->event & ~TRACE_EVENT_END;
+		const char* ph = "i";
+		if (is_span(record->event))
+		{
+			if (record->event & TRACE_EVENT_END)
+			{
+				// End of span which has started before the oldest dumped record
+				if (!open_span[id])
+				{
+					continue;
+				}
+				open_span[id] = false;
+				ph = "E";
+			}
+			else
+			{
+				open_span[id] = true;
+				ph = "B";
+			}
+		}
+		printf("%s{\"name\":\"%s\",\"ph\":\"%s\",%s\"ts\":%llu,\"pid\":1,\"tid\":1,\"args\":{\"arg0\":%u,\"arg1\":%u}}",
+				first_event ? "" : ",\n", event_name(record->event), ph, ph[0] == 'i' ? "\"s\":\"t\"," : "",
+				(unsigned long long)ts, record->arg0, record->arg1);
+		first_event = false;
+	}
+	printf("\n]}\n");
+	fprintf(stderr, "%u trace records converted\n", count);
+	return 0;
+}
@@ -0,0 +1,33 @@
+#ifndef INCLUDE_ADMISSION_H_
+#define INCLUDE_ADMISSION_H_
+
+#include <c_types.h>
+
+// New connections are rejected when free heap drops below this level (bytes)
+#ifndef ADMISSION_MIN_FREE_HEAP
+#define ADMISSION_MIN_FREE_HEAP				8192
+#endif
+// Pressure state is left once free heap recovers this much above ADMISSION_MIN_FREE_HEAP (bytes)
+#define ADMISSION_HEAP_HYSTERESIS			2048
+
+// admission_check results
+#define ADMISSION_ACCEPT					0
+#define ADMISSION_REJECT_HEAP				1
+#define ADMISSION_REJECT_CONNECTIONS		2
+
+struct admission_stats
+{
+	uint32 accepts;
+	uint32 heap_rejects;
+	uint32 connection_rejects;
+	// Number of transitions into low heap pressure state
+	uint32 pressure_events;
+	// Free heap observed on the last check
+	uint32 last_free_heap;
+	bool under_pressure;
+};
+
+uint8 admission_check(uint8 live_connections, uint8 max_connections);
+const struct admission_stats* admission_get_stats(void);
+
+#endif /* INCLUDE_ADMISSION_H_ */
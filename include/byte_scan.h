@@ -0,0 +1,16 @@
+#ifndef INCLUDE_BYTE_SCAN_H_
+#define INCLUDE_BYTE_SCAN_H_
+
+#include <c_types.h>
+
+// Word-at-a-time (SWAR) scanners for received payloads. Buffers are walked with aligned 32-bit loads,
+// unaligned head and tail bytes are handled byte by byte.
+
+// Returns index of the last byte within [lo, hi] range, or -1 if there is none. Range must lie within 0x00..0x7F.
+sint32 byte_scan_last_in_range(const uint8* data, uint16 length, uint8 lo, uint8 hi);
+// Returns index of the first byte within [lo, hi] range, or length if there is none. Range must lie within 0x00..0x7F.
+uint16 byte_scan_first_in_range(const uint8* data, uint16 length, uint8 lo, uint8 hi);
+// Returns index of the first byte equal to value, or length if there is none
+uint16 byte_scan_first(const uint8* data, uint16 length, uint8 value);
+
+#endif /* INCLUDE_BYTE_SCAN_H_ */
@@ -0,0 +1,30 @@
+#ifndef INCLUDE_CHAN_SCORE_H_
+#define INCLUDE_CHAN_SCORE_H_
+
+#include <c_types.h>
+
+// Scored 2.4GHz channels: 1..CHAN_SCORE_CHANNELS
+#ifndef CHAN_SCORE_CHANNELS
+#define CHAN_SCORE_CHANNELS					13
+#endif
+// Cost of every access point found on the channel, regardless of its signal
+#define CHAN_SCORE_AP_WEIGHT				10
+// Signal cost grows linearly from 0 at CHAN_SCORE_RSSI_FLOOR (dBm) up to CHAN_SCORE_RSSI_MAX_WEIGHT
+#define CHAN_SCORE_RSSI_FLOOR				-100
+#define CHAN_SCORE_RSSI_MAX_WEIGHT			70
+
+// Channel congestion scores, lower is better. 20MHz wide channel overlaps 3 neighbours on each side (5MHz spacing),
+// so access point cost is also added to them, weighted down with distance.
+struct chan_score
+{
+	// Access points found on the channel itself
+	uint8 aps[CHAN_SCORE_CHANNELS];
+	uint16 scores[CHAN_SCORE_CHANNELS];
+};
+
+void chan_score_reset(struct chan_score* score);
+void chan_score_add(struct chan_score* score, uint8 channel, sint8 rssi);
+uint16 chan_score_get(const struct chan_score* score, uint8 channel);
+uint8 chan_score_best(const struct chan_score* score, uint8 preferred);
+
+#endif /* INCLUDE_CHAN_SCORE_H_ */
@@ -0,0 +1,46 @@
+#ifndef INCLUDE_CHAN_SELECT_H_
+#define INCLUDE_CHAN_SELECT_H_
+
+#include <c_types.h>
+
+#include "chan_score.h"
+
+// Access point channel used when boot scan fails
+#ifndef CHAN_SELECT_DEFAULT
+#define CHAN_SELECT_DEFAULT					10
+#endif
+// Period of channel re-evaluation (seconds), 0 - channel is selected at boot only.
+// Limited by deadline scheduler horizon.
+#ifndef CHAN_SELECT_RESCAN_SEC
+#define CHAN_SELECT_RESCAN_SEC				0
+#endif
+#if CHAN_SELECT_RESCAN_SEC > 2000
+#error CHAN_SELECT_RESCAN_SEC is out of deadline scheduler horizon
+#endif
+// Re-evaluation moves access point only to a channel which scores at least that much (percent) lower than current one
+#ifndef CHAN_SELECT_MIGRATE_PCT
+#define CHAN_SELECT_MIGRATE_PCT				25
+#endif
+
+// Returns true if access point can be moved to another channel now
+typedef bool (* chan_select_idle_fn)(void);
+// Sets up access point on selected channel: once at boot, then on every migration
+typedef void (* chan_select_apply_fn)(uint8 channel, bool migration);
+
+struct chan_select_stats
+{
+	// Access point channel
+	uint8 channel;
+	// Access points found by the latest scan
+	uint8 aps_found;
+	uint32 scans;
+	uint32 scan_failures;
+	uint32 migrations;
+	// Scores of the latest scan
+	struct chan_score score;
+};
+
+void chan_select_start(chan_select_apply_fn apply, chan_select_idle_fn idle);
+const struct chan_select_stats* chan_select_get_stats(void);
+
+#endif /* INCLUDE_CHAN_SELECT_H_ */
@@ -0,0 +1,121 @@
+#ifndef INCLUDE_CMD_FRAME_H_
+#define INCLUDE_CMD_FRAME_H_
+
+#include <c_types.h>
+
+// Binary command frame layout (multi-byte fields are little-endian):
+// [0]      magic byte CMD_FRAME_MAGIC (never collides with '0'..'7' digit commands)
+// [1]      opcode
+// [2..3]   sequence number, echoed back in reply
+// [4]      payload length
+// [5..]    payload
+// [last 2] CRC-16/CCITT-FALSE over all preceding frame bytes
+#define CMD_FRAME_MAGIC						0xA5
+#define CMD_FRAME_HEADER_SZ					5
+#define CMD_FRAME_CRC_SZ					2
+#define CMD_FRAME_MAX_PAYLOAD				128
+#define CMD_FRAME_MAX_SZ					(CMD_FRAME_HEADER_SZ + CMD_FRAME_MAX_PAYLOAD + CMD_FRAME_CRC_SZ)
+
+// Request opcodes. Reply carries request opcode with CMD_OPCODE_REPLY bit set.
+#define CMD_OPCODE_OUTPUT_BATCH				0x01
+#define CMD_OPCODE_STATE_QUERY				0x02
+#define CMD_OPCODE_LATENCY_QUERY			0x03
+#define CMD_OPCODE_COUNTERS_QUERY			0x04
+#define CMD_OPCODE_MEMORY_QUERY				0x05
+#define CMD_OPCODE_TRACE_DUMP				0x06
+#define CMD_OPCODE_LOG_SINK					0x07
+#define CMD_OPCODE_STATION_QUERY			0x08
+#define CMD_OPCODE_SCHED_QUERY				0x09
+#define CMD_OPCODE_CPU_QUERY				0x0A
+#define CMD_OPCODE_CHANNEL_QUERY			0x0B
+#define CMD_OPCODE_ADMISSION_QUERY			0x0C
+#define CMD_OPCODE_RECLAIM_QUERY			0x0D
+#define CMD_OPCODE_REPLY					0x80
+
+// Output operations carried by CMD_OPCODE_OUTPUT_BATCH payload as [op, mask] pairs
+#define CMD_OUTPUT_OP_SZ					2
+#define CMD_OUTPUT_WRITE					0x00
+#define CMD_OUTPUT_SET						0x01
+#define CMD_OUTPUT_CLEAR					0x02
+#define CMD_OUTPUT_TOGGLE					0x03
+
+// CMD_OPCODE_STATE_QUERY reply payload: [status, outputs mask, connection state, stations, connections,
+// uptime seconds (4), free heap bytes (4)]
+#define CMD_STATE_REPLY_SZ					13
+
+// CMD_OPCODE_LATENCY_QUERY optional 1-byte payload flags
+#define CMD_LATENCY_LOG						0x01
+#define CMD_LATENCY_RESET					0x02
+// CMD_OPCODE_LATENCY_QUERY reply payload: [status, samples (4), p50 (4), p90 (4), p99 (4), max (4)],
+// command receive to GPIO write latency in microseconds
+#define CMD_LATENCY_REPLY_SZ				21
+// CMD_OPCODE_COUNTERS_QUERY optional 1-byte payload selects connection slot, server-wide counters are reported by default
+#define CMD_COUNTERS_TOTAL					0xFF
+// CMD_OPCODE_COUNTERS_QUERY reply payload: [status, selector, rx bytes (4), receive callbacks (4), commands (4),
+// ignored bytes (4), accepts (4), disconnects (4), reconnect errors (4)]
+#define CMD_COUNTERS_REPLY_SZ				30
+// CMD_OPCODE_MEMORY_QUERY reply payload: [status, free heap current (4), min (4), avg (4), low-water events (4),
+// last low-water event time (4), free heap at last low-water event (4), stack max (2),
+// stack max of init done, timer, TCP accept, TCP receive, TCP sent and UDP receive callbacks (2 each)]
+#define CMD_MEMORY_REPLY_SZ					39
+// CMD_OPCODE_TRACE_DUMP request payload: [page]. Page 0 request takes snapshot of trace ring content,
+// following pages are served from that snapshot.
+// Reply payload: [status, page, pages, records, sequence number of the first record (4), records (8 each)]
+#define CMD_TRACE_HEADER_SZ					8
+#define CMD_TRACE_PAGE_RECORDS				15
+// CMD_OPCODE_LOG_SINK optional 1-byte payload selects log sinks (LOG_SINK_* mask), empty payload only queries them.
+// Reply payload: [status, selected sinks, present network sinks, batches (4), bytes (4), dropped bytes (4)]
+#define CMD_LOG_SINK_REPLY_SZ				15
+// CMD_OPCODE_STATION_QUERY reply payload: [status, stations, connects (4), disconnects (4), resyncs (4)], followed by
+// [MAC (6), association id, connect time (4), last seen time (4)] per station, times are uptime seconds
+#define CMD_STATION_HEADER_SZ				14
+#define CMD_STATION_ENTRY_SZ				15
+// CMD_OPCODE_SCHED_QUERY reply payload: [status, timer wakeups (4), early wakeups (4), tasks], followed by
+// [task id (SCHED_TASK_*), runs (4), average start lateness (4), maximum start lateness (4), skipped periods (4)]
+// per task, lateness is in microseconds
+#define CMD_SCHED_HEADER_SZ					10
+#define CMD_SCHED_TASK_SZ					17
+#define CMD_SCHED_MAX_TASKS					((CMD_FRAME_MAX_PAYLOAD - CMD_SCHED_HEADER_SZ) / CMD_SCHED_TASK_SZ)
+// CMD_OPCODE_CPU_QUERY reply payload: [status, CPU frequency (MHz), switches to 160MHz (4), switches to 80MHz (4),
+// time at 80MHz (4), time at 160MHz (4)], times are in milliseconds
+#define CMD_CPU_REPLY_SZ					18
+// CMD_OPCODE_CHANNEL_QUERY reply payload: [status, access point channel, access points found, scans (4),
+// scan failures (4), migrations (4)], followed by [access points (1), score (2)] per channel 1..13 of the latest scan
+#define CMD_CHANNEL_HEADER_SZ				15
+#define CMD_CHANNEL_ENTRY_SZ				3
+// CMD_OPCODE_ADMISSION_QUERY reply payload: [status, under heap pressure, accepts (4), heap rejects (4),
+// connection rejects (4), pressure events (4), free heap at last check (4), deferred aborts (4), aborts done (4),
+// aborts of connections already gone (4), aborts not deferred because queue was full (4)]
+#define CMD_ADMISSION_REPLY_SZ				38
+// CMD_OPCODE_RECLAIM_QUERY reply payload: [status, idle timeout seconds (2), disconnects (4), idle reclaims (4),
+// keepalive reclaims (4), error reclaims (4), idle reclaims ended in error (4)]
+#define CMD_RECLAIM_REPLY_SZ				23
+
+// Reply status codes
+#define CMD_STATUS_OK						0x00
+#define CMD_STATUS_BAD_OPCODE				0x01
+#define CMD_STATUS_BAD_LENGTH				0x02
+#define CMD_STATUS_BAD_OPERATION			0x03
+#define CMD_STATUS_BAD_ARGUMENT				0x04
+#define CMD_STATUS_TRACE_LOST				0x05
+
+// cmd_frame_decode results
+#define CMD_FRAME_DECODED					0
+#define CMD_FRAME_INCOMPLETE				1
+#define CMD_FRAME_INVALID					2
+
+struct cmd_frame
+{
+	uint8 opcode;
+	uint16 seq;
+	uint8 length;
+	const uint8* payload;
+};
+
+uint16 cmd_frame_crc16(const uint8* data, uint16 length, uint16 crc);
+uint8 cmd_frame_decode(const uint8* buf, uint16 length, struct cmd_frame* frame, uint16* consumed);
+uint16 cmd_frame_encode(uint8* buf, uint8 opcode, uint16 seq, const uint8* payload, uint8 length);
+uint8* cmd_frame_put_le16(uint8* buf, uint16 value);
+uint8* cmd_frame_put_le32(uint8* buf, uint32 value);
+
+#endif /* INCLUDE_CMD_FRAME_H_ */
@@ -0,0 +1,44 @@
+#ifndef INCLUDE_CMD_PARSER_H_
+#define INCLUDE_CMD_PARSER_H_
+
+#include <c_types.h>
+
+#include "cmd_frame.h"
+
+// Input digit-chars range which is recognized as digit commands
+#define CMD_PARSER_DIGITS_START				'0'
+#define CMD_PARSER_DIGITS_END				'7'
+
+// Parser states
+#define CMD_PARSER_STATE_IDLE				0
+#define CMD_PARSER_STATE_FRAME				1
+
+// cmd_parser_next results
+#define CMD_PARSER_NONE						0
+#define CMD_PARSER_DIGIT					1
+#define CMD_PARSER_FRAME					2
+#define CMD_PARSER_ERROR					3
+
+// Incremental per-connection parser of digit commands and binary command frames.
+// Frame bytes split across several segments are collected in fixed reassembly buffer.
+struct cmd_parser
+{
+	uint8 state;
+	uint16 collected;
+	uint8 buffer[CMD_FRAME_MAX_SZ];
+};
+
+// Command produced by parser. Frame payload stays valid until the next cmd_parser_next call.
+struct cmd_parser_command
+{
+	char digit;
+	struct cmd_frame frame;
+	// Consumed bytes dropped by digit filter (non-command bytes)
+	uint16 ignored;
+};
+
+void cmd_parser_reset(struct cmd_parser* parser);
+uint8 cmd_parser_next(struct cmd_parser* parser, const uint8* data, uint16 length, uint16* consumed,
+		struct cmd_parser_command* command);
+
+#endif /* INCLUDE_CMD_PARSER_H_ */
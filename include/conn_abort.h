@@ -0,0 +1,30 @@
+#ifndef INCLUDE_CONN_ABORT_H_
+#define INCLUDE_CONN_ABORT_H_
+
+#include <c_types.h>
+#include <espconn.h>
+
+// User task priority taken by deferred aborts
+#ifndef CONN_ABORT_TASK_PRIO
+#define CONN_ABORT_TASK_PRIO				USER_TASK_PRIO_0
+#endif
+// Aborts which may wait for task at once
+#ifndef CONN_ABORT_QUEUE_LEN
+#define CONN_ABORT_QUEUE_LEN				4
+#endif
+
+struct conn_abort_stats
+{
+	uint32 deferred;
+	// Aborts done by task and aborts of connections which were gone by then
+	uint32 aborted;
+	uint32 stale;
+	// Aborts not deferred because task queue was full
+	uint32 overflows;
+};
+
+void conn_abort_init(void);
+bool conn_abort_defer(struct espconn* pesp_conn);
+const struct conn_abort_stats* conn_abort_get_stats(void);
+
+#endif /* INCLUDE_CONN_ABORT_H_ */
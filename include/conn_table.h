@@ -0,0 +1,94 @@
+#ifndef INCLUDE_CONN_TABLE_H_
+#define INCLUDE_CONN_TABLE_H_
+
+#include <c_types.h>
+#include <espconn.h>
+
+#include "cmd_parser.h"
+#include "tx_queue.h"
+#include "timer_wheel.h"
+
+// Maximum number of simultaneously served client TCP connections (matches espconn default limit)
+#define CONN_TABLE_SIZE						5
+// Connection table tick period (ms), conn_table_tick is expected to be called with this period
+#define CONN_TABLE_TICK_MS					100
+// Connection which has not received any data within this time is reclaimed by idle reaper (seconds),
+// matches SDK server timeout used before idle reaper
+#ifndef CONN_IDLE_TIMEOUT_SEC
+#define CONN_IDLE_TIMEOUT_SEC				60
+#endif
+
+// Connection slot release reasons
+#define CONN_RELEASE_DISCONNECT				0
+#define CONN_RELEASE_ERROR					1
+#define CONN_RELEASE_KEEPALIVE				2
+
+// Reclaimed connections counters
+struct conn_table_stats
+{
+	// Connections closed by peer or by server
+	uint32 disconnects;
+	// Connections closed by idle reaper
+	uint32 idle_reclaims;
+	// Connections dropped by error callback
+	uint32 error_reclaims;
+	// Connections dropped because keepalive probes were not answered
+	uint32 keepalive_reclaims;
+	// Idle reclaims which ended in error: connection was gone when closed, or error callback came instead of disconnect
+	uint32 idle_reclaim_errors;
+};
+
+// Throughput counters ids. Counters are monotonic: kept both table-wide and per slot, slot counters
+// accumulate over every connection served by the slot.
+#define CONN_COUNTER_RX_BYTES				0
+#define CONN_COUNTER_RX_CALLBACKS			1
+#define CONN_COUNTER_COMMANDS				2
+#define CONN_COUNTER_IGNORED_BYTES			3
+#define CONN_COUNTER_ACCEPTS				4
+#define CONN_COUNTER_DISCONNECTS			5
+#define CONN_COUNTER_RECONNECT_ERRORS		6
+#define CONN_COUNTERS_NUM					7
+
+struct conn_counters
+{
+	uint32 values[CONN_COUNTERS_NUM];
+};
+
+// Per-connection client state. Slots are preallocated, nothing is allocated at accept time.
+struct conn_slot
+{
+	// Connection owning the slot (NULL - slot is free)
+	struct espconn* conn;
+	// Remote endpoint, together with espconn pointer identifies the connection
+	uint8 remote_ip[4];
+	int remote_port;
+	// Slot index within connection table
+	uint8 index;
+	// system_get_time timestamps of accept and of the last received segment
+	uint32 accepted_at;
+	uint32 last_rx_at;
+	// Idle reaper timer and connection table tick of the last received segment
+	struct timer_wheel_entry idle_timer;
+	uint32 last_rx_tick;
+	// Set once idle reaper has requested connection close
+	bool idle_reclaimed;
+	struct cmd_parser parser;
+	struct tx_queue tx;
+	struct conn_counters counters;
+};
+
+typedef void (* conn_table_idle_fn)(struct conn_slot* slot);
+
+void conn_table_init(void);
+struct conn_slot* conn_table_acquire(struct espconn* pesp_conn);
+struct conn_slot* conn_table_lookup(struct espconn* pesp_conn);
+void conn_table_touch(struct conn_slot* slot);
+void conn_table_release(struct conn_slot* slot, uint8 reason);
+void conn_table_tick(conn_table_idle_fn idle_fn);
+struct conn_slot* conn_table_get(uint8 index);
+uint8 conn_table_count(void);
+const struct conn_table_stats* conn_table_get_stats(void);
+void conn_table_add_counter(struct conn_slot* slot, uint8 counter, uint32 value);
+void conn_table_snapshot(struct conn_counters* total, struct conn_counters* slots);
+
+#endif /* INCLUDE_CONN_TABLE_H_ */
@@ -0,0 +1,49 @@
+#ifndef INCLUDE_CPU_GOV_H_
+#define INCLUDE_CPU_GOV_H_
+
+#include <c_types.h>
+
+// Load is evaluated over windows of CPU_GOV_WINDOW_MS, windows are sampled only while receive callbacks come
+// or CPU runs at 160MHz
+#ifndef CPU_GOV_WINDOW_MS
+#define CPU_GOV_WINDOW_MS					100
+#endif
+// Switches to 160MHz once a window has at least CPU_GOV_UP_RECEIVES receive callbacks
+// or receive callbacks were busy for at least CPU_GOV_UP_BUSY_PCT percent of it
+#ifndef CPU_GOV_UP_RECEIVES
+#define CPU_GOV_UP_RECEIVES					20
+#endif
+#ifndef CPU_GOV_UP_BUSY_PCT
+#define CPU_GOV_UP_BUSY_PCT					25
+#endif
+// Switches back to 80MHz after CPU_GOV_DOWN_WINDOWS consecutive windows with no more than CPU_GOV_DOWN_RECEIVES
+// receive callbacks and no more than CPU_GOV_DOWN_BUSY_PCT percent busy time
+#ifndef CPU_GOV_DOWN_RECEIVES
+#define CPU_GOV_DOWN_RECEIVES				4
+#endif
+#ifndef CPU_GOV_DOWN_BUSY_PCT
+#define CPU_GOV_DOWN_BUSY_PCT				5
+#endif
+#ifndef CPU_GOV_DOWN_WINDOWS
+#define CPU_GOV_DOWN_WINDOWS				20
+#endif
+
+struct cpu_gov_stats
+{
+	// Current CPU frequency (MHz)
+	uint8 freq;
+	uint32 switches_up;
+	uint32 switches_down;
+	// Frequency switches refused by SDK
+	uint32 switch_errors;
+	// Time spent at each frequency (ms)
+	uint32 ms_at_80;
+	uint32 ms_at_160;
+};
+
+void cpu_gov_init(void);
+void cpu_gov_account_receive(uint32 started_at);
+void cpu_gov_update_time(void);
+const struct cpu_gov_stats* cpu_gov_get_stats(void);
+
+#endif /* INCLUDE_CPU_GOV_H_ */
@@ -0,0 +1,65 @@
+#ifndef INCLUDE_DEADLINE_SCHED_H_
+#define INCLUDE_DEADLINE_SCHED_H_
+
+#include <c_types.h>
+#include <os_type.h>
+
+// Maximum number of registered tasks
+#ifndef DEADLINE_SCHED_MAX_TASKS
+#define DEADLINE_SCHED_MAX_TASKS			8
+#endif
+
+// heap_index value of task which is not scheduled
+#define DEADLINE_SCHED_IDLE					0xFF
+
+struct deadline_sched_task;
+
+typedef void (* deadline_sched_fn)(struct deadline_sched_task* task);
+
+// Task start lateness against its deadline (microseconds)
+struct deadline_sched_jitter
+{
+	uint32 runs;
+	uint32 last;
+	uint32 max;
+	uint64 sum;
+	// Periods skipped because periodic task started after its next deadline
+	uint32 overruns;
+};
+
+// Task entry, kept by its owner. Deadlines are system_get_time() values, so tasks are ordered correctly
+// as long as deadlines are less than 2^31 microseconds (~35 minutes) ahead.
+struct deadline_sched_task
+{
+	deadline_sched_fn fn;
+	// Stable id given by owner, registration index depends on build configuration
+	uint8 id;
+	uint32 deadline;
+	// Period (microseconds), 0 for one-shot task
+	uint32 period;
+	// Position in deadline heap
+	uint8 heap_index;
+	struct deadline_sched_jitter jitter;
+};
+
+struct deadline_sched_stats
+{
+	// Timer callbacks, timer callbacks which found no task due and task runs
+	uint32 wakeups;
+	uint32 early_wakeups;
+	uint32 runs;
+};
+
+void deadline_sched_init(os_timer_t* timer);
+bool deadline_sched_register(struct deadline_sched_task* task, uint8 id, deadline_sched_fn fn);
+void deadline_sched_at(struct deadline_sched_task* task, uint32 deadline);
+void deadline_sched_after(struct deadline_sched_task* task, uint32 delay_us);
+void deadline_sched_every(struct deadline_sched_task* task, uint32 period_us);
+void deadline_sched_cancel(struct deadline_sched_task* task);
+bool deadline_sched_pending(const struct deadline_sched_task* task);
+uint8 deadline_sched_run(void);
+uint8 deadline_sched_count(void);
+const struct deadline_sched_task* deadline_sched_get(uint8 index);
+const struct deadline_sched_stats* deadline_sched_get_stats(void);
+
+#endif /* INCLUDE_DEADLINE_SCHED_H_ */
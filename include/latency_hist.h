@@ -0,0 +1,23 @@
+#ifndef INCLUDE_LATENCY_HIST_H_
+#define INCLUDE_LATENCY_HIST_H_
+
+#include <c_types.h>
+
+// Bucket 0 counts zero samples, bucket i (i > 0) counts samples within [2^(i-1), 2^i) microseconds.
+// The last bucket also takes every longer sample (over ~0.5 second).
+#define LATENCY_HIST_BUCKETS				21
+
+// Fixed log2-bucket histogram: constant RAM and O(1) recording cost, percentiles are resolved
+// to bucket upper bound (within factor of 2), maximum is exact
+struct latency_hist
+{
+	uint32 count;
+	uint32 max;
+	uint32 buckets[LATENCY_HIST_BUCKETS];
+};
+
+void latency_hist_reset(struct latency_hist* hist);
+void latency_hist_add(struct latency_hist* hist, uint32 value);
+uint32 latency_hist_percentile(const struct latency_hist* hist, uint16 permille);
+
+#endif /* INCLUDE_LATENCY_HIST_H_ */
@@ -0,0 +1,32 @@
+#ifndef INCLUDE_LOG_BINARY_H_
+#define INCLUDE_LOG_BINARY_H_
+
+#include <c_types.h>
+
+// Binary log record: marker, call site id (LE16), payload length and payload. Payload holds arguments
+// in call order: numbers as LEB128 varints of their 32-bit value, %s strings as varint length and bytes.
+// Formats are not sent: host decoder (host/tools/log_decode.c) looks them up in dictionary extracted
+// from sources at build time (host/tools/log_dict.c).
+#define LOG_BINARY_MARKER					0x1E
+#define LOG_BINARY_HEADER_SZ				4
+#define LOG_BINARY_PAYLOAD_MAX				255
+// Longer %s arguments are truncated. Fits whole payload dump line (mod_dump.c), the longest string logged.
+#define LOG_BINARY_STRING_MAX				80
+#define LOG_BINARY_VARINT_MAX				5
+
+// Call site id: source module id and line number of the log statement
+#define LOG_BINARY_LINE_BITS				12
+#define LOG_BINARY_ID(module, line)			((uint16)(((module) << LOG_BINARY_LINE_BITS) \
+		| ((line) & ((1 << LOG_BINARY_LINE_BITS) - 1))))
+
+// Number of log statement arguments, up to 8
+#define LOG_BINARY_NARGS(...)				LOG_BINARY_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_BINARY_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...)	n
+
+#if defined(UART_DEBUG_LOGS) && defined(UART_BINARY_LOGS)
+
+void log_binary_write(uint16 id, const char* string_format, uint8 nargs, ...);
+
+#endif
+
+#endif /* INCLUDE_LOG_BINARY_H_ */
@@ -0,0 +1,38 @@
+#ifndef INCLUDE_LOG_RATE_H_
+#define INCLUDE_LOG_RATE_H_
+
+#include <c_types.h>
+
+// Token bucket of every log call site: up to LOG_RATE_BURST messages at once,
+// refilled with LOG_RATE_PER_SEC messages per second
+#ifndef LOG_RATE_BURST
+#define LOG_RATE_BURST						10
+#endif
+#ifndef LOG_RATE_PER_SEC
+#define LOG_RATE_PER_SEC					20
+#endif
+#define LOG_RATE_INTERVAL_US				(1000000 / LOG_RATE_PER_SEC)
+// Period of suppressed messages summary (ms)
+#ifndef LOG_RATE_SUMMARY_MS
+#define LOG_RATE_SUMMARY_MS					10000
+#endif
+
+// Call site state, zero initialized. Token bucket is kept in GCRA form: time when the bucket is full again.
+struct log_site
+{
+	uint32 full_time;
+	uint32 suppressed;
+	// Sites with suppressed messages are linked into summary list, id is set once linked
+	struct log_site* next;
+	uint16 id;
+	uint16 sample_count;
+};
+
+#ifdef UART_DEBUG_LOGS
+
+bool log_rate_allow(struct log_site* site, uint16 id, uint16 sample);
+void log_rate_poll(void);
+
+#endif
+
+#endif /* INCLUDE_LOG_RATE_H_ */
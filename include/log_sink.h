@@ -0,0 +1,57 @@
+#ifndef INCLUDE_LOG_SINK_H_
+#define INCLUDE_LOG_SINK_H_
+
+#include <c_types.h>
+
+// Log output sinks, any combination can be selected at runtime
+#define LOG_SINK_UART						0x01
+// Datagrams to collector, which subscribes by sending any datagram to LOG_SINK_PORT
+#define LOG_SINK_UDP						0x02
+// Stream to subscriber connected to LOG_SINK_PORT
+#define LOG_SINK_TCP						0x04
+#define LOG_SINK_ALL						(LOG_SINK_UART | LOG_SINK_UDP | LOG_SINK_TCP)
+
+// Sinks enabled at boot. Network sinks send nothing until a collector or subscriber shows up,
+// units without serial cable can be built with UART sink off.
+#ifndef LOG_SINK_DEFAULT
+#define LOG_SINK_DEFAULT					LOG_SINK_ALL
+#endif
+// UDP and TCP port of network sinks
+#ifndef LOG_SINK_PORT
+#define LOG_SINK_PORT						1011
+#endif
+// Network batch size: fits into single Ethernet frame with IP and UDP or TCP headers
+#define LOG_SINK_BATCH_SZ					1400
+// User task sending batches which filled up in os_printf output, conn_abort task takes USER_TASK_PRIO_0
+#ifndef LOG_SINK_TASK_PRIO
+#define LOG_SINK_TASK_PRIO					USER_TASK_PRIO_1
+#endif
+// Partially filled batch is sent after this time (ms)
+#ifndef LOG_SINK_FLUSH_MS
+#define LOG_SINK_FLUSH_MS					200
+#endif
+
+struct log_sink_stats
+{
+	// Batches and bytes taken by at least one network sink
+	uint32 batches;
+	uint32 bytes;
+	// Bytes dropped because both batch buffers were taken (TCP send in flight) or no sink took the batch
+	uint32 dropped;
+	// LOG_SINK_UDP / LOG_SINK_TCP bits of network sinks with collector or subscriber present
+	uint8 subscribers;
+};
+
+#ifdef UART_DEBUG_LOGS
+
+void log_sink_init(void);
+void log_sink_listen(void);
+void log_sink_poll(void);
+void log_sink_write(const uint8* data, uint16 length);
+void log_sink_select(uint8 sinks);
+uint8 log_sink_selected(void);
+const struct log_sink_stats* log_sink_get_stats(void);
+
+#endif
+
+#endif /* INCLUDE_LOG_SINK_H_ */
@@ -0,0 +1,59 @@
+#ifndef INCLUDE_MEM_WATCH_H_
+#define INCLUDE_MEM_WATCH_H_
+
+#include <c_types.h>
+
+// Free heap level below which low-water event is recorded (bytes)
+#ifndef MEM_WATCH_HEAP_LOW_WATER
+#define MEM_WATCH_HEAP_LOW_WATER			12288
+#endif
+// Next low-water event is recorded only after free heap has recovered by this amount above the level (bytes)
+#define MEM_WATCH_HEAP_REARM				1024
+// Number of the latest low-water events kept
+#define MEM_WATCH_EVENTS					4
+
+// Size of stack area painted at boot below mem_watch_init caller frame (bytes, multiple of 4)
+#ifndef MEM_WATCH_STACK_PAINT_SZ
+#define MEM_WATCH_STACK_PAINT_SZ			4096
+#endif
+// Gap left between mem_watch_init caller frame and painted area, covers frames of painting code itself (bytes)
+#define MEM_WATCH_STACK_GUARD_SZ			256
+#define MEM_WATCH_STACK_PATTERN				0xA5C3E1F0
+
+// Callbacks with own stack high-water marks
+#define MEM_WATCH_CB_INIT_DONE				0
+#define MEM_WATCH_CB_TIMER					1
+#define MEM_WATCH_CB_TCP_ACCEPT				2
+#define MEM_WATCH_CB_TCP_RECV				3
+#define MEM_WATCH_CB_TCP_SENT				4
+#define MEM_WATCH_CB_UDP_RECV				5
+#define MEM_WATCH_CB_NUM					6
+
+// Low-water event: system_get_time timestamp and state at the moment of the event
+struct mem_watch_event
+{
+	uint32 time;
+	uint32 free_heap;
+	uint8 connections;
+};
+
+struct mem_watch_stats
+{
+	uint32 heap_current;
+	uint32 heap_min;
+	uint32 heap_avg;
+	uint32 samples;
+	uint32 low_water_events;
+	// The latest low-water events, the newest one is at (low_water_events - 1) % MEM_WATCH_EVENTS
+	struct mem_watch_event events[MEM_WATCH_EVENTS];
+	// Deepest stack use below painted area top, overall and per callback (bytes)
+	uint16 stack_max;
+	uint16 stack_cb_max[MEM_WATCH_CB_NUM];
+};
+
+void mem_watch_init(void);
+void mem_watch_sample_heap(uint8 connections);
+void mem_watch_check_stack(uint8 callback);
+const struct mem_watch_stats* mem_watch_get_stats(void);
+
+#endif /* INCLUDE_MEM_WATCH_H_ */
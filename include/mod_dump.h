@@ -0,0 +1,20 @@
+#ifndef INCLUDE_MOD_DUMP_H_
+#define INCLUDE_MOD_DUMP_H_
+
+#include <c_types.h>
+
+#ifdef UART_DEBUG_LOGS
+
+// Maximum number of payload bytes printed by dump_payload (can be overridden from build configuration)
+#ifndef UART_DEBUG_DUMP_BYTES
+#define UART_DEBUG_DUMP_BYTES				16
+#endif
+
+// Bytes printed per single dump line
+#define DUMP_BYTES_PER_LINE					16
+
+void dump_payload(const char* data, uint16 length);
+
+#endif
+
+#endif /* INCLUDE_MOD_DUMP_H_ */
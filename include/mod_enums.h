@@ -3,6 +3,9 @@
 
 #include <user_interface.h>
 
+#include "log_binary.h"
+#include "log_rate.h"
+
 #ifdef UART_DEBUG_LOGS
 
 void lookup_station_status(char* buffer, uint8 value);
@@ -11,10 +14,170 @@ void lookup_espconn_error(char* buffer, sint8 value);
 
 #endif
 
+// Log levels. Messages above module level are compiled out together with their format strings.
+#define LOG_LEVEL_NONE						0
+#define LOG_LEVEL_ERROR						1
+#define LOG_LEVEL_WARN						2
+#define LOG_LEVEL_INFO						3
+#define LOG_LEVEL_DEBUG						4
+
+// Default level of all modules, can be overridden from build configuration (e.g. -DLOG_LEVEL_DEFAULT=LOG_LEVEL_WARN)
+#ifndef LOG_LEVEL_DEFAULT
+#define LOG_LEVEL_DEFAULT					LOG_LEVEL_DEBUG
+#endif
+
+// Per module levels (e.g. -DLOG_LEVEL_MAIN=LOG_LEVEL_INFO -DLOG_LEVEL_TX_QUEUE=LOG_LEVEL_ERROR)
+// and module ids of binary log records
+#ifndef LOG_LEVEL_MAIN
+#define LOG_LEVEL_MAIN						LOG_LEVEL_DEFAULT
+#endif
+#define LOG_ID_MAIN							1
+#ifndef LOG_LEVEL_ADMISSION
+#define LOG_LEVEL_ADMISSION					LOG_LEVEL_DEFAULT
+#endif
+#define LOG_ID_ADMISSION					2
+#ifndef LOG_LEVEL_CONN_TABLE
+#define LOG_LEVEL_CONN_TABLE				LOG_LEVEL_DEFAULT
+#endif
+#define LOG_ID_CONN_TABLE					3
+#ifndef LOG_LEVEL_MEM_WATCH
+#define LOG_LEVEL_MEM_WATCH					LOG_LEVEL_DEFAULT
+#endif
+#define LOG_ID_MEM_WATCH					4
+#ifndef LOG_LEVEL_TX_QUEUE
+#define LOG_LEVEL_TX_QUEUE					LOG_LEVEL_DEFAULT
+#endif
+#define LOG_ID_TX_QUEUE						5
+#ifndef LOG_LEVEL_UART_LOG
+#define LOG_LEVEL_UART_LOG					LOG_LEVEL_DEFAULT
+#endif
+#define LOG_ID_UART_LOG						6
+#ifndef LOG_LEVEL_DUMP
+#define LOG_LEVEL_DUMP						LOG_LEVEL_DEFAULT
+#endif
+#define LOG_ID_DUMP							7
+#ifndef LOG_LEVEL_LOG_RATE
+#define LOG_LEVEL_LOG_RATE					LOG_LEVEL_DEFAULT
+#endif
+#define LOG_ID_LOG_RATE						8
+#ifndef LOG_LEVEL_LOG_SINK
+#define LOG_LEVEL_LOG_SINK					LOG_LEVEL_DEFAULT
+#endif
+#define LOG_ID_LOG_SINK						9
+#ifndef LOG_LEVEL_STATION_TABLE
+#define LOG_LEVEL_STATION_TABLE				LOG_LEVEL_DEFAULT
+#endif
+#define LOG_ID_STATION_TABLE				10
+#ifndef LOG_LEVEL_CPU_GOV
+#define LOG_LEVEL_CPU_GOV					LOG_LEVEL_DEFAULT
+#endif
+#define LOG_ID_CPU_GOV						11
+#ifndef LOG_LEVEL_CHAN_SELECT
+#define LOG_LEVEL_CHAN_SELECT				LOG_LEVEL_DEFAULT
+#endif
+#define LOG_ID_CHAN_SELECT					12
+#define LOG_LEVEL_OTHER						LOG_LEVEL_DEFAULT
+#define LOG_ID_OTHER						0
+
+// Deadline scheduler task ids, reported by CMD_OPCODE_SCHED_QUERY. Registration order depends on build
+// configuration (log task, channel re-evaluation task), ids do not.
+#define SCHED_TASK_HOUSEKEEPING				1
+#define SCHED_TASK_CONN						2
+#define SCHED_TASK_STATUS_LED				3
+#define SCHED_TASK_CPU_GOV					4
+#define SCHED_TASK_LOG						5
+#define SCHED_TASK_CHAN_RESCAN				6
+
+// Source module is selected by defining LOG_MODULE before any include, e.g. #define LOG_MODULE TX_QUEUE
+#ifndef LOG_MODULE
+#define LOG_MODULE							OTHER
+#endif
+#define LOG_CONCAT_(a, b)					a##b
+#define LOG_CONCAT(a, b)					LOG_CONCAT_(a, b)
+#define LOG_MODULE_LEVEL					LOG_CONCAT(LOG_LEVEL_, LOG_MODULE)
+#define LOG_MODULE_ID						LOG_CONCAT(LOG_ID_, LOG_MODULE)
+
+// Level check usable in #if, for log-only code (buffers, lookups) around log statements
 #ifdef UART_DEBUG_LOGS
-#define OS_UART_LOG(...) os_printf(__VA_ARGS__)
+#define LOG_ENABLED(level)					(LOG_MODULE_LEVEL >= (level))
+#else
+#define LOG_ENABLED(level)					0
+#endif
+
+#if defined(LOG_DICT_EXTRACT)
+// Dictionary extraction pass (preprocessor only, see host/tools/log_dict.c): every call site is emitted
+// with the same module id and line number, which are compiled into its binary records
+#define OS_UART_LOG_EMIT(format, ...)		LOG_DICT_ENTRY LOG_MODULE_ID __LINE__ format LOG_DICT_END
+#elif defined(UART_DEBUG_LOGS) && defined(UART_BINARY_LOGS)
+// Binary records: call site id and raw argument words, no format string in image. Format of the few
+// call sites with %s arguments is kept in flash, so that string contents can be sent.
+#define OS_UART_LOG_EMIT(format, ...) \
+	log_binary_write(LOG_BINARY_ID(LOG_MODULE_ID, __LINE__), \
+			__builtin_strstr(format, "%s") ? \
+			({ static const char log_format[] ICACHE_RODATA_ATTR STORE_ATTR = format; log_format; }) : NULL, \
+			LOG_BINARY_NARGS(__VA_ARGS__), ##__VA_ARGS__)
+#elif defined(UART_DEBUG_LOGS)
+// Format string is kept in flash and read by SDK formatter with aligned 32-bit loads,
+// so only enabled messages and no format strings at all occupy DRAM
+#define OS_UART_LOG_EMIT(format, ...) \
+	do \
+	{ \
+		static const char log_format[] ICACHE_RODATA_ATTR STORE_ATTR = format; \
+		os_printf_plus(log_format, ##__VA_ARGS__); \
+	} while (0)
+#else
+#define OS_UART_LOG_EMIT(...)
+#endif
+
+// Every call site has its own token bucket (see log_rate.h), so a flood of one message does not saturate UART.
+// With sample > 1 only the first of each sample messages is passed to token bucket.
+#if defined(UART_DEBUG_LOGS) && !defined(LOG_DICT_EXTRACT)
+#define OS_UART_LOG_SITE(sample, format, ...) \
+	do \
+	{ \
+		static struct log_site log_site; \
+		if (log_rate_allow(&log_site, LOG_BINARY_ID(LOG_MODULE_ID, __LINE__), (sample))) \
+		{ \
+			OS_UART_LOG_EMIT(format, ##__VA_ARGS__); \
+		} \
+	} while (0)
+#else
+#define OS_UART_LOG_SITE(sample, format, ...)	OS_UART_LOG_EMIT(format, ##__VA_ARGS__)
+#endif
+
+#define OS_UART_LOG(format, ...)			OS_UART_LOG_SITE(1, format, ##__VA_ARGS__)
+
+// OS_UART_LOG_<LEVEL>_SAMPLED(n, ...) variants log 1 in n messages, for hot path call sites
+#if LOG_ENABLED(LOG_LEVEL_ERROR)
+#define OS_UART_LOG_ERROR(format, ...)		OS_UART_LOG("[ERROR] " format, ##__VA_ARGS__)
+#define OS_UART_LOG_ERROR_SAMPLED(n, format, ...)	OS_UART_LOG_SITE(n, "[ERROR] " format, ##__VA_ARGS__)
+#else
+#define OS_UART_LOG_ERROR(...)
+#define OS_UART_LOG_ERROR_SAMPLED(...)
+#endif
+
+#if LOG_ENABLED(LOG_LEVEL_WARN)
+#define OS_UART_LOG_WARN(format, ...)		OS_UART_LOG("[WARN] " format, ##__VA_ARGS__)
+#define OS_UART_LOG_WARN_SAMPLED(n, format, ...)	OS_UART_LOG_SITE(n, "[WARN] " format, ##__VA_ARGS__)
+#else
+#define OS_UART_LOG_WARN(...)
+#define OS_UART_LOG_WARN_SAMPLED(...)
+#endif
+
+#if LOG_ENABLED(LOG_LEVEL_INFO)
+#define OS_UART_LOG_INFO(format, ...)		OS_UART_LOG("[INFO] " format, ##__VA_ARGS__)
+#define OS_UART_LOG_INFO_SAMPLED(n, format, ...)	OS_UART_LOG_SITE(n, "[INFO] " format, ##__VA_ARGS__)
+#else
+#define OS_UART_LOG_INFO(...)
+#define OS_UART_LOG_INFO_SAMPLED(...)
+#endif
+
+#if LOG_ENABLED(LOG_LEVEL_DEBUG)
+#define OS_UART_LOG_DEBUG(format, ...)		OS_UART_LOG("[DEBUG] " format, ##__VA_ARGS__)
+#define OS_UART_LOG_DEBUG_SAMPLED(n, format, ...)	OS_UART_LOG_SITE(n, "[DEBUG] " format, ##__VA_ARGS__)
 #else
-#define OS_UART_LOG(...)
+#define OS_UART_LOG_DEBUG(...)
+#define OS_UART_LOG_DEBUG_SAMPLED(...)
 #endif
 
 #endif /* INCLUDE_MOD_ENUMS_H_ */
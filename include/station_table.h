@@ -0,0 +1,43 @@
+#ifndef INCLUDE_STATION_TABLE_H_
+#define INCLUDE_STATION_TABLE_H_
+
+#include <c_types.h>
+
+// Number of tracked WiFi stations (SDK soft-AP accepts 4 stations at most)
+#ifndef STATION_TABLE_SIZE
+#define STATION_TABLE_SIZE					4
+#endif
+
+// Station association id is not known when station was found by consistency check rather than by event
+#define STATION_AID_UNKNOWN					0
+
+struct station_entry
+{
+	uint8 mac[6];
+	uint8 aid;
+	bool used;
+	// Uptime (seconds) of connect event and of the latest event seen from the station
+	uint32 connected_at;
+	uint32 last_seen;
+};
+
+struct station_table_stats
+{
+	uint32 connects;
+	uint32 disconnects;
+	uint32 probe_requests;
+	// Connect events dropped because table was full
+	uint32 overflows;
+	// Consistency checks which found table out of sync with SDK station list
+	uint32 resyncs;
+};
+
+void station_table_connected(const uint8* mac, uint8 aid, uint32 now);
+bool station_table_disconnected(const uint8* mac);
+void station_table_seen(const uint8* mac, uint32 now);
+bool station_table_check(uint32 now);
+uint8 station_table_count(void);
+const struct station_entry* station_table_get(uint8 index);
+const struct station_table_stats* station_table_get_stats(void);
+
+#endif /* INCLUDE_STATION_TABLE_H_ */
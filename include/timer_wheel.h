@@ -0,0 +1,33 @@
+#ifndef INCLUDE_TIMER_WHEEL_H_
+#define INCLUDE_TIMER_WHEEL_H_
+
+#include <c_types.h>
+
+// Number of wheel buckets (power of 2). Timeouts longer than wheel size take several wheel revolutions.
+#define TIMER_WHEEL_BUCKETS					64
+
+// Timer entry, embedded into owner structure. Entry is scheduled while pprev is not NULL.
+struct timer_wheel_entry
+{
+	struct timer_wheel_entry* next;
+	struct timer_wheel_entry** pprev;
+	// Absolute expiration tick
+	uint32 expires;
+};
+
+// Hashed timing wheel: entry is placed to bucket (expiration tick % TIMER_WHEEL_BUCKETS),
+// so schedule, cancel and per-tick advance cost O(1) regardless of number of timers.
+struct timer_wheel
+{
+	uint32 now;
+	struct timer_wheel_entry* buckets[TIMER_WHEEL_BUCKETS];
+};
+
+typedef void (* timer_wheel_expired_fn)(struct timer_wheel_entry* entry);
+
+void timer_wheel_init(struct timer_wheel* wheel);
+void timer_wheel_schedule(struct timer_wheel* wheel, struct timer_wheel_entry* entry, uint32 ticks);
+void timer_wheel_cancel(struct timer_wheel_entry* entry);
+void timer_wheel_advance(struct timer_wheel* wheel, timer_wheel_expired_fn expired_fn);
+
+#endif /* INCLUDE_TIMER_WHEEL_H_ */
@@ -0,0 +1,47 @@
+#ifndef INCLUDE_TRACE_RING_H_
+#define INCLUDE_TRACE_RING_H_
+
+#include <c_types.h>
+
+// Number of records kept in ring (power of 2), the oldest records are overwritten
+#ifndef TRACE_RING_RECORDS
+#define TRACE_RING_RECORDS					256
+#endif
+
+// Serialized record layout (little-endian): [time (4), event (1), arg0 (1), arg1 (2)]
+#define TRACE_RECORD_SZ						8
+
+// Callback span events are written twice: on callback entry and, with TRACE_EVENT_END bit set, right before return.
+// Arguments below are of entry record unless stated otherwise, end record arguments are 0.
+#define TRACE_EVENT_END						0x80
+// Event ids
+// Scheduler timer wakeup (span): arg0 - 0, arg1 - wakeup index; end record arg0 - number of tasks run
+#define TRACE_EV_TIMER						0x01
+// Accepted connection (span): arg0 - 0, arg1 - remote port; end record arg0 - connection slot (0xFF - rejected)
+#define TRACE_EV_ACCEPT						0x02
+// Received TCP segment (span): arg0 - connection slot (0xFF - unknown connection), arg1 - length;
+// end record arg0 - connection slot
+#define TRACE_EV_RECV						0x03
+// Received UDP datagram (span): arg0 - 0, arg1 - length
+#define TRACE_EV_UDP_RECV					0x04
+// Applied digit command (instant): arg0 - outputs mask, arg1 - 0
+#define TRACE_EV_DIGIT						0x05
+// Disconnected connection (instant): arg0 - connection slot, arg1 - 0
+#define TRACE_EV_DISCONNECT					0x06
+// Connection error (instant): arg0 - connection slot (0xFF - unknown connection), arg1 - espconn error code
+#define TRACE_EV_RECONNECT					0x07
+
+// Trace record, time is system_get_time timestamp (microseconds)
+struct trace_record
+{
+	uint32 time;
+	uint8 event;
+	uint8 arg0;
+	uint16 arg1;
+};
+
+void trace_ring_write(uint8 event, uint8 arg0, uint16 arg1);
+uint32 trace_ring_head(void);
+bool trace_ring_read(uint32 seq, struct trace_record* record);
+
+#endif /* INCLUDE_TRACE_RING_H_ */
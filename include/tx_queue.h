@@ -0,0 +1,45 @@
+#ifndef INCLUDE_TX_QUEUE_H_
+#define INCLUDE_TX_QUEUE_H_
+
+#include <c_types.h>
+#include <espconn.h>
+
+// Number of preallocated transmit buffers per connection
+#define TX_QUEUE_SLOTS						3
+// Size of single transmit buffer. Messages are never split between buffers.
+#define TX_QUEUE_SLOT_SZ					256
+
+struct tx_queue_slot
+{
+	uint16 length;
+	uint8 data[TX_QUEUE_SLOT_SZ];
+};
+
+// Per-connection transmit ring. Only one buffer is passed to espconn_send at a time,
+// the next one is sent from espconn sent callback. Small messages queued behind in-flight
+// buffer are coalesced into a single buffer and so into a single send.
+struct tx_queue
+{
+	struct espconn* conn;
+	uint8 head;
+	uint8 count;
+	bool in_flight;
+	// Bytes passed to espconn_send
+	uint32 bytes;
+	// Successful espconn_send calls
+	uint32 sends;
+	// Messages appended to already queued buffer
+	uint32 coalesced;
+	// Messages rejected because all buffers were in use
+	uint32 queue_full;
+	// Failed espconn_send calls (buffer is kept and retried)
+	uint32 send_errors;
+	struct tx_queue_slot slots[TX_QUEUE_SLOTS];
+};
+
+void tx_queue_init(struct tx_queue* queue, struct espconn* conn);
+bool tx_queue_push(struct tx_queue* queue, const uint8* data, uint16 length);
+void tx_queue_flush(struct tx_queue* queue);
+void tx_queue_on_sent(struct tx_queue* queue);
+
+#endif /* INCLUDE_TX_QUEUE_H_ */
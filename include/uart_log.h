@@ -0,0 +1,47 @@
+#ifndef INCLUDE_UART_LOG_H_
+#define INCLUDE_UART_LOG_H_
+
+#include <c_types.h>
+
+#ifdef UART_DEBUG_LOGS
+
+// Log ring size (bytes, power of 2). About 180ms of output at 115200 baud.
+#ifndef UART_LOG_RING_SZ
+#define UART_LOG_RING_SZ					2048
+#endif
+
+// UART0 registers used by log drain
+#define UART_LOG_BASE						0x60000000
+#define UART_LOG_FIFO						(UART_LOG_BASE + 0x00)
+#define UART_LOG_INT_ST						(UART_LOG_BASE + 0x08)
+#define UART_LOG_INT_ENA					(UART_LOG_BASE + 0x0C)
+#define UART_LOG_INT_CLR					(UART_LOG_BASE + 0x10)
+#define UART_LOG_STATUS						(UART_LOG_BASE + 0x1C)
+#define UART_LOG_CONF1						(UART_LOG_BASE + 0x24)
+#define UART_LOG_TXFIFO_EMPTY_INT			BIT(1)
+#define UART_LOG_TXFIFO_CNT					0xFF
+#define UART_LOG_TXFIFO_CNT_S				16
+#define UART_LOG_TXFIFO_EMPTY_THRHD			0x7F
+#define UART_LOG_TXFIFO_EMPTY_THRHD_S		8
+#define UART_LOG_FIFO_SZ					128
+// TX FIFO empty interrupt is raised once FIFO holds fewer bytes than this
+#define UART_LOG_TXFIFO_REFILL_LEVEL		16
+
+struct uart_log_stats
+{
+	// Bytes accepted to ring and bytes written to UART TX FIFO
+	uint32 written;
+	uint32 drained;
+	// Log lines truncated and binary records dropped because ring was full
+	uint32 dropped_lines;
+};
+
+void uart_log_init(void);
+void uart_log_poll(void);
+bool uart_log_write(const uint8* data, uint16 length);
+void uart_log_putc(char c);
+const struct uart_log_stats* uart_log_get_stats(void);
+
+#endif
+
+#endif /* INCLUDE_UART_LOG_H_ */
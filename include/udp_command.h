@@ -0,0 +1,37 @@
+#ifndef INCLUDE_UDP_COMMAND_H_
+#define INCLUDE_UDP_COMMAND_H_
+
+#include <c_types.h>
+
+// Datagram layout: "[<seq>:]<digits>", where optional <seq> is decimal sequence number (0..65535, wraps around)
+// and the last command digit of <digits> is applied, same as for TCP digit commands
+#define UDP_COMMAND_SEQ_SEPARATOR			':'
+#define UDP_COMMAND_SEQ_MAX_DIGITS			5
+// Sequence window is restarted once no sequenced datagram was accepted for this period (ms),
+// so restarted sender is not locked out until its counter catches up
+#ifndef UDP_COMMAND_SEQ_RESYNC_MS
+#define UDP_COMMAND_SEQ_RESYNC_MS			2000
+#endif
+// Sequence windows are kept per sender (IP address and port). When all are taken, window of the sender which
+// has gone longest without accepted datagram is given to the new one.
+#ifndef UDP_COMMAND_SEQ_WINDOWS
+#define UDP_COMMAND_SEQ_WINDOWS				4
+#endif
+
+// udp_command_process results
+#define UDP_COMMAND_APPLY					0
+#define UDP_COMMAND_STALE					1
+#define UDP_COMMAND_MALFORMED				2
+
+struct udp_command_stats
+{
+	uint32 datagrams;
+	uint32 applied;
+	uint32 stale;
+	uint32 malformed;
+};
+
+uint8 udp_command_process(const uint8* data, uint16 length, const uint8* remote_ip, int remote_port, uint8* digit);
+const struct udp_command_stats* udp_command_get_stats(void);
+
+#endif /* INCLUDE_UDP_COMMAND_H_ */
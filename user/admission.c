@@ -0,0 +1,51 @@
+#define LOG_MODULE	ADMISSION
+
+#include "admission.h"
+
+#include <osapi.h>
+#include <user_interface.h>
+
+#include "mod_enums.h"
+
+static struct admission_stats stats;
+
+// Decides whether just accepted connection can be served. Called before any callback is registered for connection,
+// so rejected connection costs neither connection slot nor heap.
+uint8 ICACHE_FLASH_ATTR admission_check(uint8 live_connections, uint8 max_connections)
+{
+	uint32 free_heap = system_get_free_heap_size();
+	stats.last_free_heap = free_heap;
+
+	if (stats.under_pressure)
+	{
+		if (free_heap >= ADMISSION_MIN_FREE_HEAP + ADMISSION_HEAP_HYSTERESIS)
+		{
+			stats.under_pressure = false;
+			OS_UART_LOG_INFO("Heap pressure is over, free heap: %d\n", free_heap);
+		}
+	}
+	else if (free_heap < ADMISSION_MIN_FREE_HEAP)
+	{
+		stats.under_pressure = true;
+		stats.pressure_events++;
+		OS_UART_LOG_WARN("Heap pressure, free heap: %d\n", free_heap);
+	}
+
+	if (stats.under_pressure)
+	{
+		stats.heap_rejects++;
+		return ADMISSION_REJECT_HEAP;
+	}
+	if (live_connections >= max_connections)
+	{
+		stats.connection_rejects++;
+		return ADMISSION_REJECT_CONNECTIONS;
+	}
+	stats.accepts++;
+	return ADMISSION_ACCEPT;
+}
+
+const struct admission_stats* ICACHE_FLASH_ATTR admission_get_stats(void)
+{
+	return &stats;
+}
@@ -0,0 +1,139 @@
+#define LOG_MODULE	CHAN_SELECT
+
+#include "chan_select.h"
+
+#include <osapi.h>
+#include <user_interface.h>
+
+#include "mod_enums.h"
+#include "deadline_sched.h"
+
+static chan_select_apply_fn apply_fn = NULL;
+static chan_select_idle_fn idle_fn = NULL;
+#if CHAN_SELECT_RESCAN_SEC
+static struct deadline_sched_task rescan_task;
+#endif
+static struct chan_select_stats stats;
+
+// Scores scan results. Returns false if scan has failed.
+LOCAL bool ICACHE_FLASH_ATTR process_scan(void* arg, STATUS status)
+{
+	struct bss_info* bss;
+	if (status != OK)
+	{
+		stats.scan_failures++;
+		OS_UART_LOG_WARN("WiFi scan failed, status %d\n", status);
+		return false;
+	}
+	stats.scans++;
+	stats.aps_found = 0;
+	chan_score_reset(&stats.score);
+	for (bss = arg; bss; bss = STAILQ_NEXT(bss, next))
+	{
+		chan_score_add(&stats.score, bss->channel, bss->rssi);
+		if (stats.aps_found < 0xFF)
+		{
+			stats.aps_found++;
+		}
+	}
+#if LOG_ENABLED(LOG_LEVEL_DEBUG)
+	// Whole report is one log statement, so per call site rate limit never hides some of the channels
+	char aps_str[CHAN_SCORE_CHANNELS * 4 + 1];
+	char scores_str[CHAN_SCORE_CHANNELS * 6 + 1];
+	char* aps_out = aps_str;
+	char* scores_out = scores_str;
+	uint8 channel;
+	*aps_out = 0;
+	*scores_out = 0;
+	for (channel = 1; channel <= CHAN_SCORE_CHANNELS; ++channel)
+	{
+		aps_out += os_sprintf(aps_out, channel > 1 ? " %d" : "%d", stats.score.aps[channel - 1]);
+		scores_out += os_sprintf(scores_out, channel > 1 ? " %d" : "%d", chan_score_get(&stats.score, channel));
+	}
+	OS_UART_LOG_DEBUG("Channels 1-%d access points: %s, scores: %s\n", CHAN_SCORE_CHANNELS, aps_str, scores_str);
+#endif
+	return true;
+}
+
+LOCAL void ICACHE_FLASH_ATTR on_boot_scan_done(void* arg, STATUS status)
+{
+	uint8 channel = CHAN_SELECT_DEFAULT;
+	if (process_scan(arg, status))
+	{
+		channel = chan_score_best(&stats.score, CHAN_SELECT_DEFAULT);
+	}
+	OS_UART_LOG_INFO("Access point channel %d selected (score %d), %d access points found\n",
+			channel, chan_score_get(&stats.score, channel), stats.aps_found);
+	// Station interface was needed for the scan only
+	wifi_set_opmode(SOFTAP_MODE);
+	stats.channel = channel;
+	apply_fn(channel, false);
+#if CHAN_SELECT_RESCAN_SEC
+	deadline_sched_every(&rescan_task, CHAN_SELECT_RESCAN_SEC * 1000000);
+#endif
+}
+
+#if CHAN_SELECT_RESCAN_SEC
+LOCAL void ICACHE_FLASH_ATTR on_rescan_done(void* arg, STATUS status)
+{
+	wifi_set_opmode_current(SOFTAP_MODE);
+	if (!process_scan(arg, status))
+	{
+		return;
+	}
+	uint8 best = chan_score_best(&stats.score, stats.channel);
+	uint32 best_score = chan_score_get(&stats.score, best);
+	uint32 current_score = chan_score_get(&stats.score, stats.channel);
+	// Clients may have connected while scan was running
+	if (best != stats.channel && best_score * 100 <= current_score * (100 - CHAN_SELECT_MIGRATE_PCT) && idle_fn())
+	{
+		stats.migrations++;
+		OS_UART_LOG_INFO("Access point moves from channel %d (score %d) to channel %d (score %d)\n",
+				stats.channel, current_score, best, best_score);
+		stats.channel = best;
+		apply_fn(best, true);
+	}
+	else
+	{
+		OS_UART_LOG_DEBUG("Access point stays on channel %d (score %d), best channel %d (score %d)\n",
+				stats.channel, current_score, best, best_score);
+	}
+}
+
+// Re-evaluation is skipped while access point is in use, as scan takes radio off access point channel
+LOCAL void ICACHE_FLASH_ATTR on_rescan_task(struct deadline_sched_task* task)
+{
+	(void)task;
+	if (!idle_fn())
+	{
+		return;
+	}
+	if (!wifi_set_opmode_current(STATIONAP_MODE) || !wifi_station_scan(NULL, on_rescan_done))
+	{
+		stats.scan_failures++;
+		OS_UART_LOG_WARN("Unable to start WiFi scan\n");
+		wifi_set_opmode_current(SOFTAP_MODE);
+	}
+}
+#endif
+
+// Scans channels and calls apply with the least congested one. Station interface has to be enabled
+// (STATIONAP_MODE), it is disabled once the scan is done.
+void ICACHE_FLASH_ATTR chan_select_start(chan_select_apply_fn apply, chan_select_idle_fn idle)
+{
+	apply_fn = apply;
+	idle_fn = idle;
+#if CHAN_SELECT_RESCAN_SEC
+	deadline_sched_register(&rescan_task, SCHED_TASK_CHAN_RESCAN, on_rescan_task);
+#endif
+	if (!wifi_station_scan(NULL, on_boot_scan_done))
+	{
+		// Failure is accounted as failed scan, access point comes up on default channel
+		on_boot_scan_done(NULL, FAIL);
+	}
+}
+
+const struct chan_select_stats* ICACHE_FLASH_ATTR chan_select_get_stats(void)
+{
+	return &stats;
+}
@@ -0,0 +1,101 @@
+#include "cmd_frame.h"
+
+#include <osapi.h>
+
+// CRC-16/CCITT-FALSE nibble lookup table (kept in RAM: flash allows aligned 32-bit reads only)
+static const uint16 crc16_nibble_table[16] =
+{
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+// Calculates CRC-16/CCITT-FALSE. Initial crc value is 0xFFFF, can be chained over several blocks.
+uint16 ICACHE_FLASH_ATTR cmd_frame_crc16(const uint8* data, uint16 length, uint16 crc)
+{
+	while (length--)
+	{
+		crc = (crc << 4) ^ crc16_nibble_table[((crc >> 12) ^ (*data >> 4)) & 0x0F];
+		crc = (crc << 4) ^ crc16_nibble_table[((crc >> 12) ^ (*data & 0x0F)) & 0x0F];
+		data++;
+	}
+	return crc;
+}
+
+// Decodes single frame located at the beginning of buffer.
+// On CMD_FRAME_DECODED frame payload points inside buf and consumed holds full frame size.
+// On CMD_FRAME_INVALID consumed holds number of bytes to skip before frame search is resumed.
+uint8 ICACHE_FLASH_ATTR cmd_frame_decode(const uint8* buf, uint16 length, struct cmd_frame* frame, uint16* consumed)
+{
+	*consumed = 0;
+	if (!length)
+	{
+		return CMD_FRAME_INCOMPLETE;
+	}
+	if (buf[0] != CMD_FRAME_MAGIC)
+	{
+		*consumed = 1;
+		return CMD_FRAME_INVALID;
+	}
+	if (length < CMD_FRAME_HEADER_SZ)
+	{
+		return CMD_FRAME_INCOMPLETE;
+	}
+	if (buf[4] > CMD_FRAME_MAX_PAYLOAD)
+	{
+		*consumed = 1;
+		return CMD_FRAME_INVALID;
+	}
+
+	uint16 frame_sz = CMD_FRAME_HEADER_SZ + buf[4] + CMD_FRAME_CRC_SZ;
+	if (length < frame_sz)
+	{
+		return CMD_FRAME_INCOMPLETE;
+	}
+
+	uint16 crc = buf[frame_sz - 2] | (buf[frame_sz - 1] << 8);
+	if (cmd_frame_crc16(buf, frame_sz - CMD_FRAME_CRC_SZ, 0xFFFF) != crc)
+	{
+		*consumed = 1;
+		return CMD_FRAME_INVALID;
+	}
+
+	frame->opcode = buf[1];
+	frame->seq = buf[2] | (buf[3] << 8);
+	frame->length = buf[4];
+	frame->payload = buf + CMD_FRAME_HEADER_SZ;
+	*consumed = frame_sz;
+	return CMD_FRAME_DECODED;
+}
+
+// Encodes frame into buf, which should be able to hold CMD_FRAME_HEADER_SZ + length + CMD_FRAME_CRC_SZ bytes.
+// Returns encoded frame size.
+uint16 ICACHE_FLASH_ATTR cmd_frame_encode(uint8* buf, uint8 opcode, uint16 seq, const uint8* payload, uint8 length)
+{
+	buf[0] = CMD_FRAME_MAGIC;
+	buf[1] = opcode;
+	buf[2] = seq & 0xFF;
+	buf[3] = seq >> 8;
+	buf[4] = length;
+	if (length)
+	{
+		os_memcpy(buf + CMD_FRAME_HEADER_SZ, payload, length);
+	}
+	uint16 crc = cmd_frame_crc16(buf, CMD_FRAME_HEADER_SZ + length, 0xFFFF);
+	buf[CMD_FRAME_HEADER_SZ + length] = crc & 0xFF;
+	buf[CMD_FRAME_HEADER_SZ + length + 1] = crc >> 8;
+	return CMD_FRAME_HEADER_SZ + length + CMD_FRAME_CRC_SZ;
+}
+
+// Little-endian field writers for reply payloads, return position right after written field
+uint8* ICACHE_FLASH_ATTR cmd_frame_put_le16(uint8* buf, uint16 value)
+{
+	buf[0] = value & 0xFF;
+	buf[1] = value >> 8;
+	return buf + 2;
+}
+
+uint8* ICACHE_FLASH_ATTR cmd_frame_put_le32(uint8* buf, uint32 value)
+{
+	buf = cmd_frame_put_le16(buf, value & 0xFFFF);
+	return cmd_frame_put_le16(buf, value >> 16);
+}
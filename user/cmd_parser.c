@@ -0,0 +1,137 @@
+#include "cmd_parser.h"
+
+#include <osapi.h>
+
+#include "byte_scan.h"
+
+void ICACHE_FLASH_ATTR cmd_parser_reset(struct cmd_parser* parser)
+{
+	parser->state = CMD_PARSER_STATE_IDLE;
+	parser->collected = 0;
+}
+
+// Returns full size of frame collected in reassembly buffer, or 0 when header is not complete yet
+LOCAL uint16 ICACHE_FLASH_ATTR collected_frame_size(const struct cmd_parser* parser)
+{
+	if (parser->collected < CMD_FRAME_HEADER_SZ)
+	{
+		return 0;
+	}
+	return CMD_FRAME_HEADER_SZ + parser->buffer[4] + CMD_FRAME_CRC_SZ;
+}
+
+// Continues frame reassembly from the new input chunk
+LOCAL uint8 ICACHE_FLASH_ATTR continue_frame(struct cmd_parser* parser, const uint8* data, uint16 length, uint16* consumed,
+		struct cmd_parser_command* command)
+{
+	uint16 frame_sz;
+	uint16 chunk;
+	uint16 decoded_sz;
+
+	// Header is collected first to learn payload length
+	if (parser->collected < CMD_FRAME_HEADER_SZ)
+	{
+		chunk = CMD_FRAME_HEADER_SZ - parser->collected;
+		chunk = chunk < length ? chunk : length;
+		os_memcpy(parser->buffer + parser->collected, data, chunk);
+		parser->collected += chunk;
+		*consumed += chunk;
+		data += chunk;
+		length -= chunk;
+		if (parser->collected < CMD_FRAME_HEADER_SZ)
+		{
+			return CMD_PARSER_NONE;
+		}
+		if (parser->buffer[4] > CMD_FRAME_MAX_PAYLOAD)
+		{
+			cmd_parser_reset(parser);
+			return CMD_PARSER_ERROR;
+		}
+	}
+
+	frame_sz = collected_frame_size(parser);
+	chunk = frame_sz - parser->collected;
+	chunk = chunk < length ? chunk : length;
+	os_memcpy(parser->buffer + parser->collected, data, chunk);
+	parser->collected += chunk;
+	*consumed += chunk;
+	if (parser->collected < frame_sz)
+	{
+		return CMD_PARSER_NONE;
+	}
+
+	// Frame is complete: reassembly buffer content stays intact until the next call, so payload can point into it
+	parser->state = CMD_PARSER_STATE_IDLE;
+	parser->collected = 0;
+	if (cmd_frame_decode(parser->buffer, frame_sz, &command->frame, &decoded_sz) == CMD_FRAME_DECODED)
+	{
+		return CMD_PARSER_FRAME;
+	}
+	return CMD_PARSER_ERROR;
+}
+
+// Parses input chunk until the first complete command. Number of processed input bytes is returned in consumed,
+// so the caller should call it again for the rest of the chunk. Bytes other than digit commands and frames are skipped.
+// Every digit command is reported, so applied commands do not depend on segment boundaries. Input is scanned only
+// up to the next digit, so a chunk takes linear time however many digits it carries. Frames which are complete
+// within the chunk are decoded in place, without copying to reassembly buffer.
+uint8 ICACHE_FLASH_ATTR cmd_parser_next(struct cmd_parser* parser, const uint8* data, uint16 length, uint16* consumed,
+		struct cmd_parser_command* command)
+{
+	uint16 magic_idx;
+	uint16 digit_idx;
+	uint16 frame_sz;
+	uint8 res;
+
+	*consumed = 0;
+	command->ignored = 0;
+	if (parser->state == CMD_PARSER_STATE_FRAME)
+	{
+		return continue_frame(parser, data, length, consumed, command);
+	}
+
+	// The next command is either the first digit or frame starting before it
+	digit_idx = byte_scan_first_in_range(data, length, CMD_PARSER_DIGITS_START, CMD_PARSER_DIGITS_END);
+	magic_idx = byte_scan_first(data, digit_idx, CMD_FRAME_MAGIC);
+	if (magic_idx == digit_idx && digit_idx < length)
+	{
+		*consumed = digit_idx + 1;
+		command->digit = data[digit_idx];
+		command->ignored = digit_idx;
+		return CMD_PARSER_DIGIT;
+	}
+	if (magic_idx)
+	{
+		*consumed = magic_idx;
+		command->ignored = magic_idx;
+		if (magic_idx == length)
+		{
+			return CMD_PARSER_NONE;
+		}
+		data += magic_idx;
+		length -= magic_idx;
+	}
+
+	res = cmd_frame_decode(data, length, &command->frame, &frame_sz);
+	if (res == CMD_FRAME_DECODED)
+	{
+		*consumed += frame_sz;
+		return CMD_PARSER_FRAME;
+	}
+	if (res == CMD_FRAME_INCOMPLETE)
+	{
+		parser->state = CMD_PARSER_STATE_FRAME;
+		parser->collected = 0;
+		return continue_frame(parser, data, length, consumed, command);
+	}
+	// Corrupted frame is dropped as a whole, or only its header when length field is out of range
+	if (data[4] <= CMD_FRAME_MAX_PAYLOAD)
+	{
+		*consumed += CMD_FRAME_HEADER_SZ + data[4] + CMD_FRAME_CRC_SZ;
+	}
+	else
+	{
+		*consumed += CMD_FRAME_HEADER_SZ;
+	}
+	return CMD_PARSER_ERROR;
+}
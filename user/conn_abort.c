@@ -0,0 +1,43 @@
+#include "conn_abort.h"
+
+#include <osapi.h>
+#include <user_interface.h>
+
+static os_event_t abort_queue[CONN_ABORT_QUEUE_LEN];
+static struct conn_abort_stats stats;
+
+// SDK looks connection up in its own list before aborting it, so connection closed by peer meanwhile is refused
+LOCAL void ICACHE_FLASH_ATTR on_abort_task(os_event_t* event)
+{
+	if (espconn_abort((struct espconn*)event->par) == ESPCONN_OK)
+	{
+		stats.aborted++;
+	}
+	else
+	{
+		stats.stale++;
+	}
+}
+
+void ICACHE_FLASH_ATTR conn_abort_init(void)
+{
+	system_os_task(on_abort_task, CONN_ABORT_TASK_PRIO, abort_queue, CONN_ABORT_QUEUE_LEN);
+}
+
+// espconn_abort must not be called from espconn callbacks, so connection is aborted from user task
+// once the callback has returned. Returns false if task queue is full.
+bool ICACHE_FLASH_ATTR conn_abort_defer(struct espconn* pesp_conn)
+{
+	if (!system_os_post(CONN_ABORT_TASK_PRIO, 0, (os_param_t)pesp_conn))
+	{
+		stats.overflows++;
+		return false;
+	}
+	stats.deferred++;
+	return true;
+}
+
+const struct conn_abort_stats* ICACHE_FLASH_ATTR conn_abort_get_stats(void)
+{
+	return &stats;
+}
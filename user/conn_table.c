@@ -0,0 +1,192 @@
+#define LOG_MODULE	CONN_TABLE
+
+#include "conn_table.h"
+
+#include <stddef.h>
+#include <osapi.h>
+#include <user_interface.h>
+
+#include "mod_enums.h"
+
+// Idle timeout expressed in connection table ticks
+#define CONN_IDLE_TIMEOUT_TICKS				(CONN_IDLE_TIMEOUT_SEC * 1000 / CONN_TABLE_TICK_MS)
+
+static struct conn_slot conn_slots[CONN_TABLE_SIZE];
+// Number of slots in use
+static uint8 conn_slots_used = 0;
+// Idle reaper timers
+static struct timer_wheel idle_wheel;
+static struct conn_table_stats stats;
+static struct conn_counters total_counters;
+// Callback requested to close idle connection during current tick
+static conn_table_idle_fn idle_callback = NULL;
+
+LOCAL bool ICACHE_FLASH_ATTR remote_matches(const struct conn_slot* slot, const struct espconn* pesp_conn)
+{
+	return slot->remote_port == pesp_conn->proto.tcp->remote_port
+			&& os_memcmp(slot->remote_ip, pesp_conn->proto.tcp->remote_ip, sizeof(slot->remote_ip)) == 0;
+}
+
+void ICACHE_FLASH_ATTR conn_table_init(void)
+{
+	timer_wheel_init(&idle_wheel);
+}
+
+// Takes free slot for accepted connection and attaches it through espconn 'reverse' field.
+// Returns NULL if all slots are in use.
+struct conn_slot* ICACHE_FLASH_ATTR conn_table_acquire(struct espconn* pesp_conn)
+{
+	uint8 idx;
+	pesp_conn->reverse = NULL;
+	for (idx = 0; idx < CONN_TABLE_SIZE; ++idx)
+	{
+		struct conn_slot* slot = &conn_slots[idx];
+		if (!slot->conn)
+		{
+			slot->conn = pesp_conn;
+			slot->index = idx;
+			os_memcpy(slot->remote_ip, pesp_conn->proto.tcp->remote_ip, sizeof(slot->remote_ip));
+			slot->remote_port = pesp_conn->proto.tcp->remote_port;
+			slot->accepted_at = system_get_time();
+			slot->last_rx_at = slot->accepted_at;
+			slot->last_rx_tick = idle_wheel.now;
+			slot->idle_reclaimed = false;
+			timer_wheel_schedule(&idle_wheel, &slot->idle_timer, CONN_IDLE_TIMEOUT_TICKS);
+			cmd_parser_reset(&slot->parser);
+			tx_queue_init(&slot->tx, pesp_conn);
+			pesp_conn->reverse = slot;
+			conn_slots_used++;
+			return slot;
+		}
+	}
+	return NULL;
+}
+
+// Finds slot of connection. Slot attached through 'reverse' field is verified against espconn pointer and remote endpoint,
+// so lookup takes O(1) in regular case. Falls back to remote endpoint search for callbacks which pass espconn resource
+// different from the accepted one (e.g. some SDK versions do so for disconnect and error callbacks).
+struct conn_slot* ICACHE_FLASH_ATTR conn_table_lookup(struct espconn* pesp_conn)
+{
+	struct conn_slot* slot = (struct conn_slot*)pesp_conn->reverse;
+	uint8 idx;
+	if (slot >= conn_slots && slot < conn_slots + CONN_TABLE_SIZE
+			&& slot->conn == pesp_conn && remote_matches(slot, pesp_conn))
+	{
+		return slot;
+	}
+	for (idx = 0; idx < CONN_TABLE_SIZE; ++idx)
+	{
+		if (conn_slots[idx].conn && remote_matches(&conn_slots[idx], pesp_conn))
+		{
+			return &conn_slots[idx];
+		}
+	}
+	return NULL;
+}
+
+// Records connection activity. Idle timer is not moved here: expired timer checks the last activity tick
+// and reschedules itself, so the receive path costs only a store.
+void ICACHE_FLASH_ATTR conn_table_touch(struct conn_slot* slot)
+{
+	slot->last_rx_at = system_get_time();
+	slot->last_rx_tick = idle_wheel.now;
+}
+
+// Returns slot back to the table and accounts release reason. Safe to call for already released slot.
+void ICACHE_FLASH_ATTR conn_table_release(struct conn_slot* slot, uint8 reason)
+{
+	if (slot->conn)
+	{
+		if (slot->idle_reclaimed)
+		{
+			stats.idle_reclaims++;
+			if (reason == CONN_RELEASE_ERROR)
+			{
+				stats.idle_reclaim_errors++;
+			}
+		}
+		else if (reason == CONN_RELEASE_KEEPALIVE)
+		{
+			stats.keepalive_reclaims++;
+		}
+		else if (reason == CONN_RELEASE_ERROR)
+		{
+			stats.error_reclaims++;
+		}
+		else
+		{
+			stats.disconnects++;
+		}
+		timer_wheel_cancel(&slot->idle_timer);
+		if (slot->conn->reverse == slot)
+		{
+			slot->conn->reverse = NULL;
+		}
+		slot->conn = NULL;
+		slot->tx.conn = NULL;
+		conn_slots_used--;
+	}
+}
+
+LOCAL void ICACHE_FLASH_ATTR on_idle_timer_expired(struct timer_wheel_entry* entry)
+{
+	struct conn_slot* slot = (struct conn_slot*)((char*)entry - offsetof(struct conn_slot, idle_timer));
+	uint32 idle_ticks = idle_wheel.now - slot->last_rx_tick;
+	if (idle_ticks < CONN_IDLE_TIMEOUT_TICKS)
+	{
+		timer_wheel_schedule(&idle_wheel, entry, CONN_IDLE_TIMEOUT_TICKS - idle_ticks);
+		return;
+	}
+	OS_UART_LOG_INFO("Connection %d.%d.%d.%d:%d is idle for %d ms, reclaiming\n",
+			slot->remote_ip[0], slot->remote_ip[1], slot->remote_ip[2], slot->remote_ip[3], slot->remote_port,
+			idle_ticks * CONN_TABLE_TICK_MS);
+	slot->idle_reclaimed = true;
+	idle_callback(slot);
+}
+
+// Advances idle reaper by one tick. idle_fn is called for connections idle longer than CONN_IDLE_TIMEOUT_SEC,
+// it is expected to close connection and eventually release its slot.
+void ICACHE_FLASH_ATTR conn_table_tick(conn_table_idle_fn idle_fn)
+{
+	idle_callback = idle_fn;
+	timer_wheel_advance(&idle_wheel, on_idle_timer_expired);
+}
+
+const struct conn_table_stats* ICACHE_FLASH_ATTR conn_table_get_stats(void)
+{
+	return &stats;
+}
+
+// Returns slot by index if it is in use, NULL otherwise
+struct conn_slot* ICACHE_FLASH_ATTR conn_table_get(uint8 index)
+{
+	if (index < CONN_TABLE_SIZE && conn_slots[index].conn)
+	{
+		return &conn_slots[index];
+	}
+	return NULL;
+}
+
+// Returns number of live connections
+uint8 ICACHE_FLASH_ATTR conn_table_count(void)
+{
+	return conn_slots_used;
+}
+
+// Hot path counter update: plain increments of preallocated table-wide and slot counters
+void ICACHE_FLASH_ATTR conn_table_add_counter(struct conn_slot* slot, uint8 counter, uint32 value)
+{
+	total_counters.values[counter] += value;
+	slot->counters.values[counter] += value;
+}
+
+// Copies table-wide counters and counters of all CONN_TABLE_SIZE slots at once
+void ICACHE_FLASH_ATTR conn_table_snapshot(struct conn_counters* total, struct conn_counters* slots)
+{
+	uint8 idx;
+	*total = total_counters;
+	for (idx = 0; idx < CONN_TABLE_SIZE; ++idx)
+	{
+		slots[idx] = conn_slots[idx].counters;
+	}
+}
@@ -0,0 +1,123 @@
+#define LOG_MODULE	CPU_GOV
+
+#include "cpu_gov.h"
+
+#include <osapi.h>
+#include <user_interface.h>
+
+#include "mod_enums.h"
+#include "deadline_sched.h"
+
+#define CPU_GOV_WINDOW_US					(CPU_GOV_WINDOW_MS * 1000)
+
+static struct deadline_sched_task window_task;
+// Load of the current window
+static uint32 window_receives = 0;
+static uint32 window_busy_us = 0;
+// Consecutive quiet windows at 160MHz
+static uint8 quiet_windows = 0;
+// Time at current frequency not yet accounted to stats
+static uint32 freq_since = 0;
+static uint32 freq_us_rem = 0;
+static struct cpu_gov_stats stats;
+
+LOCAL void ICACHE_FLASH_ATTR account_time(void)
+{
+	uint32 now = system_get_time();
+	freq_us_rem += now - freq_since;
+	freq_since = now;
+	if (stats.freq == SYS_CPU_160MHZ)
+	{
+		stats.ms_at_160 += freq_us_rem / 1000;
+	}
+	else
+	{
+		stats.ms_at_80 += freq_us_rem / 1000;
+	}
+	freq_us_rem %= 1000;
+}
+
+// Changes CPU clock only: os_timer and system_get_time run from fixed-frequency timers, UART baud rate divisor
+// is derived from 80MHz APB clock, and SDK rescales os_delay_us loop itself, so timing is kept across switches.
+// Called from task context only, never while UART interrupt or receive callback is running.
+LOCAL void ICACHE_FLASH_ATTR set_freq(uint8 freq)
+{
+	account_time();
+	if (!system_update_cpu_freq(freq) || system_get_cpu_freq() != freq)
+	{
+		stats.switch_errors++;
+		OS_UART_LOG_WARN("Unable to switch CPU to %d MHz\n", freq);
+		return;
+	}
+	stats.freq = freq;
+	if (freq == SYS_CPU_160MHZ)
+	{
+		stats.switches_up++;
+	}
+	else
+	{
+		stats.switches_down++;
+	}
+	OS_UART_LOG_INFO("CPU frequency: %d MHz, %d ms at 80 MHz, %d ms at 160 MHz\n", freq, stats.ms_at_80, stats.ms_at_160);
+}
+
+// Evaluates load of completed window. Sampling stops once CPU is back at 80MHz with no load.
+LOCAL void ICACHE_FLASH_ATTR on_window_task(struct deadline_sched_task* task)
+{
+	(void)task;
+	bool loaded = window_receives >= CPU_GOV_UP_RECEIVES
+			|| window_busy_us >= CPU_GOV_WINDOW_US / 100 * CPU_GOV_UP_BUSY_PCT;
+	bool quiet = window_receives <= CPU_GOV_DOWN_RECEIVES
+			&& window_busy_us <= CPU_GOV_WINDOW_US / 100 * CPU_GOV_DOWN_BUSY_PCT;
+	window_receives = 0;
+	window_busy_us = 0;
+	if (stats.freq != SYS_CPU_160MHZ)
+	{
+		if (loaded)
+		{
+			quiet_windows = 0;
+			set_freq(SYS_CPU_160MHZ);
+		}
+		else
+		{
+			deadline_sched_cancel(task);
+		}
+		return;
+	}
+	quiet_windows = quiet ? quiet_windows + 1 : 0;
+	if (quiet_windows >= CPU_GOV_DOWN_WINDOWS)
+	{
+		set_freq(SYS_CPU_80MHZ);
+		deadline_sched_cancel(task);
+	}
+}
+
+void ICACHE_FLASH_ATTR cpu_gov_init(void)
+{
+	deadline_sched_register(&window_task, SCHED_TASK_CPU_GOV, on_window_task);
+	stats.freq = system_get_cpu_freq();
+	freq_since = system_get_time();
+}
+
+// Accounts receive callback which started at given system time, expected to be called right before callback returns
+void ICACHE_FLASH_ATTR cpu_gov_account_receive(uint32 started_at)
+{
+	window_receives++;
+	window_busy_us += system_get_time() - started_at;
+	if (!deadline_sched_pending(&window_task))
+	{
+		deadline_sched_every(&window_task, CPU_GOV_WINDOW_US);
+	}
+}
+
+// Accounts time spent at current frequency. Has to be called at least once per system time wrap-around period.
+void ICACHE_FLASH_ATTR cpu_gov_update_time(void)
+{
+	account_time();
+}
+
+const struct cpu_gov_stats* ICACHE_FLASH_ATTR cpu_gov_get_stats(void)
+{
+	account_time();
+	return &stats;
+}
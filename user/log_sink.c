@@ -0,0 +1,285 @@
+#define LOG_MODULE	LOG_SINK
+
+#include "log_sink.h"
+
+#include <espconn.h>
+#include <osapi.h>
+#include <user_interface.h>
+
+#include "mod_enums.h"
+#include "uart_log.h"
+#include "conn_abort.h"
+
+#ifdef UART_DEBUG_LOGS
+
+struct log_batch
+{
+	uint16 length;
+	uint8 data[LOG_SINK_BATCH_SZ];
+};
+
+static uint8 selected_sinks = LOG_SINK_DEFAULT;
+static struct log_sink_stats stats;
+// One batch is filled while the other may be in flight on subscriber connection
+static struct log_batch batches[2];
+static uint8 filling = 0;
+static bool tcp_in_flight = false;
+// Batch was due while previous one was in flight, it is sent from sent callback
+static bool flush_pending = false;
+// Output produced while batch is being sent (e.g. by espconn itself) is dropped, not appended to it
+static bool flushing = false;
+// Batch which filled up in os_printf output was set aside (the one not filling) for flush task to send
+static bool flush_due = false;
+static os_event_t flush_queue[1];
+static uint32 last_flush_time = 0;
+
+static struct espconn udp_sink;
+static esp_udp udp_sink_proto;
+static uint8 collector_ip[4];
+static uint16 collector_port = 0;
+
+static struct espconn tcp_listener;
+static esp_tcp tcp_listener_proto;
+static struct espconn* subscriber = NULL;
+
+// Sends batch to present network sinks
+LOCAL void ICACHE_FLASH_ATTR send_batch(struct log_batch* batch)
+{
+	flushing = true;
+	uint8 sinks = selected_sinks & stats.subscribers;
+	bool sent = false;
+	if (sinks & LOG_SINK_UDP)
+	{
+		// Datagrams go to proto.udp remote address, which is set to collector before every send
+		os_memcpy(udp_sink.proto.udp->remote_ip, collector_ip, sizeof(collector_ip));
+		udp_sink.proto.udp->remote_port = collector_port;
+		sent = espconn_send(&udp_sink, batch->data, batch->length) == ESPCONN_OK;
+	}
+	if ((sinks & LOG_SINK_TCP) && espconn_send(subscriber, batch->data, batch->length) == ESPCONN_OK)
+	{
+		tcp_in_flight = true;
+		sent = true;
+	}
+	// Batch no sink has taken is lost
+	if (sent)
+	{
+		stats.batches++;
+		stats.bytes += batch->length;
+	}
+	else if (sinks)
+	{
+		stats.dropped += batch->length;
+	}
+	last_flush_time = system_get_time();
+	flushing = false;
+}
+
+// Sends filled batch and switches to the other buffer. Batch set aside for flush task goes first.
+LOCAL void ICACHE_FLASH_ATTR flush_batch(void)
+{
+	if (flushing || flush_due || !batches[filling].length)
+	{
+		return;
+	}
+	if (tcp_in_flight)
+	{
+		flush_pending = true;
+		return;
+	}
+	flush_pending = false;
+	send_batch(&batches[filling]);
+	filling ^= 1;
+	batches[filling].length = 0;
+}
+
+LOCAL void ICACHE_FLASH_ATTR on_flush_task(os_event_t* event)
+{
+	(void)event;
+	send_batch(&batches[filling ^ 1]);
+	flush_due = false;
+}
+
+// Data is appended as a whole, so binary records are never split between batches.
+// Runs inside os_printf, which is called from espconn and lwIP code too, so nothing is sent from here:
+// full batch is set aside for flush task and output goes on to the other buffer. While the other buffer is
+// in flight on subscriber connection, full batch is sent from sent callback and output meanwhile is dropped.
+LOCAL void ICACHE_FLASH_ATTR batch_append(const uint8* data, uint16 length)
+{
+	struct log_batch* batch = &batches[filling];
+	if (!flushing && !flush_due && batch->length && batch->length + length > LOG_SINK_BATCH_SZ)
+	{
+		if (tcp_in_flight)
+		{
+			flush_pending = true;
+		}
+		else if (system_os_post(LOG_SINK_TASK_PRIO, 0, 0))
+		{
+			flush_due = true;
+			filling ^= 1;
+			batch = &batches[filling];
+			batch->length = 0;
+		}
+	}
+	if (flushing || batch->length + length > LOG_SINK_BATCH_SZ)
+	{
+		stats.dropped += length;
+		return;
+	}
+	os_memcpy(batch->data + batch->length, data, length);
+	batch->length += length;
+}
+
+// Character output routine of os_printf
+LOCAL void ICACHE_FLASH_ATTR log_sink_putc(char c)
+{
+	if (selected_sinks & LOG_SINK_UART)
+	{
+		uart_log_putc(c);
+	}
+	if (selected_sinks & stats.subscribers)
+	{
+		batch_append((const uint8*)&c, 1);
+	}
+}
+
+// Output of binary log records
+void ICACHE_FLASH_ATTR log_sink_write(const uint8* data, uint16 length)
+{
+	if (selected_sinks & LOG_SINK_UART)
+	{
+		uart_log_write(data, length);
+	}
+	if (selected_sinks & stats.subscribers)
+	{
+		batch_append(data, length);
+	}
+}
+
+// Any datagram sent to log port subscribes its sender as collector. SDK does not fill proto.udp remote fields
+// on receive, sender is reported by connection info only.
+LOCAL void ICACHE_FLASH_ATTR on_collector_receive(void* arg, char* pusrdata, unsigned short length)
+{
+	(void)pusrdata;
+	(void)length;
+	struct espconn* pesp_conn = arg;
+	remot_info* remote = NULL;
+	if (espconn_get_connection_info(pesp_conn, &remote, 0) != ESPCONN_OK)
+	{
+		return;
+	}
+	os_memcpy(collector_ip, remote->remote_ip, sizeof(collector_ip));
+	collector_port = remote->remote_port;
+	stats.subscribers |= LOG_SINK_UDP;
+}
+
+LOCAL void ICACHE_FLASH_ATTR on_subscriber_sent(void* arg)
+{
+	(void)arg;
+	tcp_in_flight = false;
+	if (flush_pending)
+	{
+		flush_batch();
+	}
+}
+
+LOCAL void ICACHE_FLASH_ATTR release_subscriber(void)
+{
+	subscriber = NULL;
+	stats.subscribers &= ~LOG_SINK_TCP;
+	tcp_in_flight = false;
+}
+
+LOCAL void ICACHE_FLASH_ATTR on_subscriber_disconnect(void* arg)
+{
+	(void)arg;
+	release_subscriber();
+}
+
+LOCAL void ICACHE_FLASH_ATTR on_subscriber_reconnect(void* arg, sint8 err)
+{
+	(void)arg;
+	(void)err;
+	release_subscriber();
+}
+
+LOCAL void ICACHE_FLASH_ATTR on_subscriber_accepted(void* arg)
+{
+	struct espconn* pesp_conn = arg;
+	if (subscriber)
+	{
+		// Only one subscriber is served, the other one is reset once this callback returns
+		conn_abort_defer(pesp_conn);
+		return;
+	}
+	subscriber = pesp_conn;
+	espconn_regist_sentcb(pesp_conn, on_subscriber_sent);
+	espconn_regist_reconcb(pesp_conn, on_subscriber_reconnect);
+	espconn_regist_disconcb(pesp_conn, on_subscriber_disconnect);
+	espconn_set_opt(pesp_conn, ESPCONN_NODELAY);
+	stats.subscribers |= LOG_SINK_TCP;
+}
+
+// Takes over os_printf output from UART logger, has to be called after uart_log_init
+void ICACHE_FLASH_ATTR log_sink_init(void)
+{
+	system_os_task(on_flush_task, LOG_SINK_TASK_PRIO, flush_queue, sizeof(flush_queue) / sizeof(flush_queue[0]));
+	os_install_putc1((void*)log_sink_putc);
+	last_flush_time = system_get_time();
+}
+
+// Opens network sinks, has to be called once network is up
+void ICACHE_FLASH_ATTR log_sink_listen(void)
+{
+	udp_sink.type = ESPCONN_UDP;
+	udp_sink.state = ESPCONN_NONE;
+	udp_sink.proto.udp = &udp_sink_proto;
+	udp_sink.proto.udp->local_port = LOG_SINK_PORT;
+	espconn_regist_recvcb(&udp_sink, on_collector_receive);
+	sint8 udp_res = espconn_create(&udp_sink);
+
+	tcp_listener.type = ESPCONN_TCP;
+	tcp_listener.state = ESPCONN_NONE;
+	tcp_listener.proto.tcp = &tcp_listener_proto;
+	tcp_listener.proto.tcp->local_port = LOG_SINK_PORT;
+	espconn_regist_connectcb(&tcp_listener, on_subscriber_accepted);
+	sint8 tcp_res = espconn_accept(&tcp_listener);
+	if (tcp_res == ESPCONN_OK)
+	{
+		espconn_tcp_set_max_con_allow(&tcp_listener, 1);
+	}
+
+	if (udp_res == ESPCONN_OK && tcp_res == ESPCONN_OK)
+	{
+		OS_UART_LOG_INFO("Log sink accepts collectors and subscribers on port %d\n", LOG_SINK_PORT);
+	}
+	else
+	{
+		OS_UART_LOG_ERROR("Unable to open log sink port %d, UDP: %d, TCP: %d\n", LOG_SINK_PORT, udp_res, tcp_res);
+	}
+}
+
+// Sends partially filled batch once it is LOG_SINK_FLUSH_MS old
+void ICACHE_FLASH_ATTR log_sink_poll(void)
+{
+	if (batches[filling].length && system_get_time() - last_flush_time >= LOG_SINK_FLUSH_MS * 1000)
+	{
+		flush_batch();
+	}
+}
+
+void ICACHE_FLASH_ATTR log_sink_select(uint8 sinks)
+{
+	selected_sinks = sinks & LOG_SINK_ALL;
+}
+
+uint8 ICACHE_FLASH_ATTR log_sink_selected(void)
+{
+	return selected_sinks;
+}
+
+const struct log_sink_stats* ICACHE_FLASH_ATTR log_sink_get_stats(void)
+{
+	return &stats;
+}
+
+#endif
@@ -0,0 +1,121 @@
+#define LOG_MODULE	MEM_WATCH
+
+#include "mem_watch.h"
+
+#include <osapi.h>
+#include <user_interface.h>
+
+#include "mod_enums.h"
+
+#define STACK_PAINT_WORDS				(MEM_WATCH_STACK_PAINT_SZ / sizeof(uint32))
+
+static struct mem_watch_stats stats;
+// Sum of heap samples for running average
+static uint64 heap_sum = 0;
+static bool low_water = false;
+// Painted stack area [stack_bottom, stack_bottom + STACK_PAINT_WORDS), stack grows down towards stack_bottom
+static volatile uint32* stack_bottom = NULL;
+// Lowest painted word which may be dirty: words below it are known to keep the pattern
+static volatile uint32* stack_clean_below = NULL;
+
+// Fills given stack words with pattern. Has to be called from frame above the painted area.
+LOCAL void ICACHE_FLASH_ATTR paint_stack(volatile uint32* from, volatile uint32* to)
+{
+	while (from < to)
+	{
+		*from++ = MEM_WATCH_STACK_PATTERN;
+	}
+}
+
+// Paints stack area below the caller frame. Expected to be called once at boot from user_init.
+void ICACHE_FLASH_ATTR mem_watch_init(void)
+{
+	uint32 marker;
+	volatile uint32* top = (volatile uint32*)((size_t)&marker & ~(size_t)3) - MEM_WATCH_STACK_GUARD_SZ / sizeof(uint32);
+	stack_bottom = top - STACK_PAINT_WORDS;
+	paint_stack(stack_bottom, top);
+	stack_clean_below = top;
+	stats.heap_min = 0xFFFFFFFF;
+}
+
+// Heap sampling, expected to be called periodically. Low-water event is recorded once per drop below the level.
+void ICACHE_FLASH_ATTR mem_watch_sample_heap(uint8 connections)
+{
+	uint32 free_heap = system_get_free_heap_size();
+	stats.heap_current = free_heap;
+	stats.samples++;
+	heap_sum += free_heap;
+	stats.heap_avg = (uint32)(heap_sum / stats.samples);
+	if (free_heap < stats.heap_min)
+	{
+		stats.heap_min = free_heap;
+	}
+
+	if (low_water)
+	{
+		low_water = free_heap < MEM_WATCH_HEAP_LOW_WATER + MEM_WATCH_HEAP_REARM;
+	}
+	else if (free_heap < MEM_WATCH_HEAP_LOW_WATER)
+	{
+		low_water = true;
+		struct mem_watch_event* event = &stats.events[stats.low_water_events % MEM_WATCH_EVENTS];
+		event->time = system_get_time();
+		event->free_heap = free_heap;
+		event->connections = connections;
+		stats.low_water_events++;
+		OS_UART_LOG_WARN("Heap low-water: %d bytes free, %d connections, at %d us\n", free_heap, connections, event->time);
+	}
+}
+
+// Measures stack depth reached since the previous check and accounts it to the given callback.
+// Expected to be called right before callback returns: painted words overwritten since the previous check
+// are found by scanning up from painted area bottom, then painted again for the next check.
+void ICACHE_FLASH_ATTR mem_watch_check_stack(uint8 callback)
+{
+	uint32 marker;
+	if (!stack_bottom)
+	{
+		return;
+	}
+	volatile uint32* top = stack_bottom + STACK_PAINT_WORDS;
+	volatile uint32* deepest = stack_bottom;
+	while (deepest < top && *deepest == MEM_WATCH_STACK_PATTERN)
+	{
+		deepest++;
+	}
+	if (deepest < stack_clean_below)
+	{
+		stack_clean_below = deepest;
+	}
+
+	uint16 used = (uint16)((top - deepest) * sizeof(uint32));
+	if (used > stats.stack_cb_max[callback])
+	{
+		stats.stack_cb_max[callback] = used;
+	}
+	if (used > stats.stack_max)
+	{
+		stats.stack_max = used;
+		if (deepest == stack_bottom)
+		{
+			OS_UART_LOG_WARN("Stack use reached painted area bottom (%d bytes)\n", MEM_WATCH_STACK_PAINT_SZ);
+		}
+	}
+
+	// Words below this frame are free again, they are painted back so the next check measures only the next callback
+	volatile uint32* frame = (volatile uint32*)((size_t)&marker & ~(size_t)3) - MEM_WATCH_STACK_GUARD_SZ / sizeof(uint32);
+	if (frame > top)
+	{
+		frame = top;
+	}
+	if (stack_clean_below < frame)
+	{
+		paint_stack(stack_clean_below, frame);
+		stack_clean_below = frame;
+	}
+}
+
+const struct mem_watch_stats* ICACHE_FLASH_ATTR mem_watch_get_stats(void)
+{
+	return &stats;
+}
@@ -0,0 +1,152 @@
+#define LOG_MODULE	STATION_TABLE
+
+#include "station_table.h"
+
+#include <osapi.h>
+#include <user_interface.h>
+
+#include "mod_enums.h"
+
+static struct station_entry stations[STATION_TABLE_SIZE];
+// Number of entries in use
+static uint8 stations_used = 0;
+static struct station_table_stats stats;
+
+LOCAL struct station_entry* ICACHE_FLASH_ATTR station_find(const uint8* mac)
+{
+	uint8 idx;
+	for (idx = 0; idx < STATION_TABLE_SIZE; ++idx)
+	{
+		if (stations[idx].used && os_memcmp(stations[idx].mac, mac, sizeof(stations[idx].mac)) == 0)
+		{
+			return &stations[idx];
+		}
+	}
+	return NULL;
+}
+
+LOCAL struct station_entry* ICACHE_FLASH_ATTR station_add(const uint8* mac, uint8 aid, uint32 now)
+{
+	uint8 idx;
+	for (idx = 0; idx < STATION_TABLE_SIZE; ++idx)
+	{
+		struct station_entry* entry = &stations[idx];
+		if (!entry->used)
+		{
+			os_memcpy(entry->mac, mac, sizeof(entry->mac));
+			entry->aid = aid;
+			entry->used = true;
+			entry->connected_at = now;
+			entry->last_seen = now;
+			stations_used++;
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+LOCAL void ICACHE_FLASH_ATTR station_remove(struct station_entry* entry)
+{
+	entry->used = false;
+	stations_used--;
+}
+
+// Records station connect event. Station which reconnects without disconnect event keeps its entry.
+void ICACHE_FLASH_ATTR station_table_connected(const uint8* mac, uint8 aid, uint32 now)
+{
+	struct station_entry* entry = station_find(mac);
+	stats.connects++;
+	if (entry)
+	{
+		entry->aid = aid;
+		entry->connected_at = now;
+		entry->last_seen = now;
+	}
+	else if (!station_add(mac, aid, now))
+	{
+		stats.overflows++;
+		OS_UART_LOG_WARN("Station table is full, %02x:%02x:%02x:%02x:%02x:%02x is not tracked\n",
+				mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+	}
+}
+
+// Records station disconnect event. Returns false if station was not tracked.
+bool ICACHE_FLASH_ATTR station_table_disconnected(const uint8* mac)
+{
+	struct station_entry* entry = station_find(mac);
+	stats.disconnects++;
+	if (!entry)
+	{
+		return false;
+	}
+	station_remove(entry);
+	return true;
+}
+
+// Refreshes last seen time of tracked station. Probe requests of stations which are not connected are ignored.
+void ICACHE_FLASH_ATTR station_table_seen(const uint8* mac, uint32 now)
+{
+	struct station_entry* entry = station_find(mac);
+	stats.probe_requests++;
+	if (entry)
+	{
+		entry->last_seen = now;
+	}
+}
+
+// Slow consistency check against SDK station list, recovers from lost events. Returns true if table was resynced.
+bool ICACHE_FLASH_ATTR station_table_check(uint32 now)
+{
+	if (wifi_softap_get_station_num() == stations_used)
+	{
+		return false;
+	}
+	OS_UART_LOG_WARN("Station table is out of sync: %d tracked, %d reported by SDK\n",
+			stations_used, wifi_softap_get_station_num());
+	stats.resyncs++;
+	uint32 confirmed = 0;
+	uint8 idx;
+	struct station_info* first = wifi_softap_get_station_info();
+	struct station_info* info;
+	// Entries of stations which left are dropped first, so the ones which joined always find free entry
+	for (info = first; info; info = STAILQ_NEXT(info, next))
+	{
+		struct station_entry* entry = station_find(info->bssid);
+		if (entry)
+		{
+			confirmed |= (uint32)1 << (entry - stations);
+		}
+	}
+	for (idx = 0; idx < STATION_TABLE_SIZE; ++idx)
+	{
+		if (stations[idx].used && !(confirmed & ((uint32)1 << idx)))
+		{
+			station_remove(&stations[idx]);
+		}
+	}
+	for (info = first; info; info = STAILQ_NEXT(info, next))
+	{
+		if (!station_find(info->bssid) && !station_add(info->bssid, STATION_AID_UNKNOWN, now))
+		{
+			stats.overflows++;
+		}
+	}
+	wifi_softap_free_station_info();
+	return true;
+}
+
+uint8 ICACHE_FLASH_ATTR station_table_count(void)
+{
+	return stations_used;
+}
+
+// Returns station entry by index, NULL if entry is not in use
+const struct station_entry* ICACHE_FLASH_ATTR station_table_get(uint8 index)
+{
+	return index < STATION_TABLE_SIZE && stations[index].used ? &stations[index] : NULL;
+}
+
+const struct station_table_stats* ICACHE_FLASH_ATTR station_table_get_stats(void)
+{
+	return &stats;
+}
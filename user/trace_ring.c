@@ -0,0 +1,36 @@
+#include "trace_ring.h"
+
+#include <osapi.h>
+#include <user_interface.h>
+
+static struct trace_record ring[TRACE_RING_RECORDS];
+// Sequence number of the next record, record seq is kept at ring[seq % TRACE_RING_RECORDS]
+static uint32 head = 0;
+
+// Hot path writer: single timestamp read and a few stores, no checks and no allocations
+void ICACHE_FLASH_ATTR trace_ring_write(uint8 event, uint8 arg0, uint16 arg1)
+{
+	struct trace_record* record = &ring[head & (TRACE_RING_RECORDS - 1)];
+	record->time = system_get_time();
+	record->event = event;
+	record->arg0 = arg0;
+	record->arg1 = arg1;
+	head++;
+}
+
+// Returns sequence number of the next record to be written
+uint32 ICACHE_FLASH_ATTR trace_ring_head(void)
+{
+	return head;
+}
+
+// Reads record by sequence number, fails if it is not written yet or has already been overwritten
+bool ICACHE_FLASH_ATTR trace_ring_read(uint32 seq, struct trace_record* record)
+{
+	if (head - seq - 1 >= TRACE_RING_RECORDS)
+	{
+		return false;
+	}
+	*record = ring[seq & (TRACE_RING_RECORDS - 1)];
+	return true;
+}
@@ -0,0 +1,88 @@
+#define LOG_MODULE	TX_QUEUE
+
+#include "tx_queue.h"
+
+#include <osapi.h>
+
+#include "mod_enums.h"
+
+void ICACHE_FLASH_ATTR tx_queue_init(struct tx_queue* queue, struct espconn* conn)
+{
+	os_memset(queue, 0, sizeof(struct tx_queue) - sizeof(queue->slots));
+	queue->conn = conn;
+}
+
+// Queues message without sending it, so that messages generated by one callback are coalesced.
+// tx_queue_flush should be called once all messages are queued. Returns false if there is no room for message.
+bool ICACHE_FLASH_ATTR tx_queue_push(struct tx_queue* queue, const uint8* data, uint16 length)
+{
+	struct tx_queue_slot* slot;
+	if (!length || length > TX_QUEUE_SLOT_SZ)
+	{
+		return false;
+	}
+
+	if (queue->count)
+	{
+		// Appends to the last queued buffer, unless it is the one being sent
+		slot = &queue->slots[(queue->head + queue->count - 1) % TX_QUEUE_SLOTS];
+		if (!(queue->in_flight && queue->count == 1) && slot->length + length <= TX_QUEUE_SLOT_SZ)
+		{
+			os_memcpy(slot->data + slot->length, data, length);
+			slot->length += length;
+			queue->coalesced++;
+			return true;
+		}
+	}
+
+	if (queue->count == TX_QUEUE_SLOTS)
+	{
+		queue->queue_full++;
+		return false;
+	}
+
+	slot = &queue->slots[(queue->head + queue->count) % TX_QUEUE_SLOTS];
+	os_memcpy(slot->data, data, length);
+	slot->length = length;
+	queue->count++;
+	return true;
+}
+
+// Passes the oldest queued buffer to espconn_send, unless another buffer is still in flight
+void ICACHE_FLASH_ATTR tx_queue_flush(struct tx_queue* queue)
+{
+	if (queue->in_flight || !queue->count || !queue->conn)
+	{
+		return;
+	}
+
+	struct tx_queue_slot* slot = &queue->slots[queue->head];
+	sint8 res = espconn_send(queue->conn, slot->data, slot->length);
+	if (res == ESPCONN_OK)
+	{
+		queue->in_flight = true;
+		queue->sends++;
+		queue->bytes += slot->length;
+	}
+	else
+	{
+		queue->send_errors++;
+#if LOG_ENABLED(LOG_LEVEL_WARN)
+		char state_str[250];
+		lookup_espconn_error(state_str, res);
+		OS_UART_LOG_WARN("Unable to send queued data: %s\n", state_str);
+#endif
+	}
+}
+
+// Releases buffer confirmed by espconn sent callback and sends the next one
+void ICACHE_FLASH_ATTR tx_queue_on_sent(struct tx_queue* queue)
+{
+	if (queue->in_flight)
+	{
+		queue->in_flight = false;
+		queue->head = (queue->head + 1) % TX_QUEUE_SLOTS;
+		queue->count--;
+	}
+	tx_queue_flush(queue);
+}
@@ -0,0 +1,131 @@
+#include "udp_command.h"
+
+#include <osapi.h>
+#include <user_interface.h>
+
+#include "byte_scan.h"
+#include "cmd_parser.h"
+
+// Last accepted sequenced datagram of one sender
+struct udp_seq_window
+{
+	bool valid;
+	uint8 remote_ip[4];
+	int remote_port;
+	uint16 seq;
+	uint32 accepted_at;
+};
+
+static struct udp_seq_window windows[UDP_COMMAND_SEQ_WINDOWS];
+static struct udp_command_stats stats;
+
+// Parses decimal sequence number prefix, returns false if it is not a valid 16 bit number
+LOCAL bool ICACHE_FLASH_ATTR parse_seq(const uint8* data, uint16 length, uint16* seq)
+{
+	if (!length || length > UDP_COMMAND_SEQ_MAX_DIGITS)
+	{
+		return false;
+	}
+	uint32 value = 0;
+	uint16 idx;
+	for (idx = 0; idx < length; ++idx)
+	{
+		if (data[idx] < '0' || data[idx] > '9')
+		{
+			return false;
+		}
+		value = value * 10 + (data[idx] - '0');
+	}
+	if (value > 0xFFFF)
+	{
+		return false;
+	}
+	*seq = (uint16)value;
+	return true;
+}
+
+// Returns window of the sender, or the one to be given to it (released): free or expired window first,
+// then the one which has gone longest without accepted datagram
+LOCAL struct udp_seq_window* ICACHE_FLASH_ATTR find_window(const uint8* remote_ip, int remote_port, uint32 now)
+{
+	struct udp_seq_window* victim = &windows[0];
+	uint8 idx;
+	for (idx = 0; idx < UDP_COMMAND_SEQ_WINDOWS; ++idx)
+	{
+		struct udp_seq_window* window = &windows[idx];
+		if (!window->valid || now - window->accepted_at >= UDP_COMMAND_SEQ_RESYNC_MS * 1000U)
+		{
+			window->valid = false;
+			victim = victim->valid ? window : victim;
+			continue;
+		}
+		if (!os_memcmp(window->remote_ip, remote_ip, sizeof(window->remote_ip)) && window->remote_port == remote_port)
+		{
+			return window;
+		}
+		if (victim->valid && now - window->accepted_at > now - victim->accepted_at)
+		{
+			victim = window;
+		}
+	}
+	victim->valid = false;
+	return victim;
+}
+
+// Sequence numbers are compared with serial number arithmetic, so 0 follows 65535
+LOCAL bool ICACHE_FLASH_ATTR is_fresh(const struct udp_seq_window* window, uint16 seq)
+{
+	return !window->valid || (sint16)(seq - window->seq) > 0;
+}
+
+// Decodes single datagram. Datagram is applied only if it carries command digit and, when sequenced,
+// is newer than the last one applied from the same sender - stale, duplicated and reordered datagrams are dropped.
+// Unsequenced datagrams are always applied.
+uint8 ICACHE_FLASH_ATTR udp_command_process(const uint8* data, uint16 length, const uint8* remote_ip, int remote_port, uint8* digit)
+{
+	stats.datagrams++;
+	uint16 separator = byte_scan_first(data, length, UDP_COMMAND_SEQ_SEPARATOR);
+	bool sequenced = separator < length;
+	uint16 seq = 0;
+	if (sequenced)
+	{
+		if (!parse_seq(data, separator, &seq))
+		{
+			stats.malformed++;
+			return UDP_COMMAND_MALFORMED;
+		}
+		data += separator + 1;
+		length -= separator + 1;
+	}
+
+	sint32 idx = byte_scan_last_in_range(data, length, CMD_PARSER_DIGITS_START, CMD_PARSER_DIGITS_END);
+	if (idx < 0)
+	{
+		stats.malformed++;
+		return UDP_COMMAND_MALFORMED;
+	}
+
+	if (sequenced)
+	{
+		uint32 now = system_get_time();
+		struct udp_seq_window* window = find_window(remote_ip, remote_port, now);
+		if (!is_fresh(window, seq))
+		{
+			stats.stale++;
+			return UDP_COMMAND_STALE;
+		}
+		window->valid = true;
+		os_memcpy(window->remote_ip, remote_ip, sizeof(window->remote_ip));
+		window->remote_port = remote_port;
+		window->seq = seq;
+		window->accepted_at = now;
+	}
+	*digit = data[idx];
+	stats.applied++;
+	return UDP_COMMAND_APPLY;
+}
+
+const struct udp_command_stats* ICACHE_FLASH_ATTR udp_command_get_stats(void)
+{
+	return &stats;
+}
@@ -1,3 +1,5 @@
+#define LOG_MODULE	MAIN
+
 #include <mem.h>
 
 #include "osapi.h"
@@ -6,6 +8,23 @@
 #include "espconn.h"
 
 #include "mod_enums.h"
+#include "mod_dump.h"
+#include "cmd_frame.h"
+#include "cmd_parser.h"
+#include "tx_queue.h"
+#include "conn_table.h"
+#include "admission.h"
+#include "udp_command.h"
+#include "latency_hist.h"
+#include "mem_watch.h"
+#include "trace_ring.h"
+#include "uart_log.h"
+#include "log_sink.h"
+#include "station_table.h"
+#include "deadline_sched.h"
+#include "cpu_gov.h"
+#include "chan_select.h"
+#include "conn_abort.h"
 
 // Establishes ESP access point WiFi session ID. Session ID which should be visible to other devices.
 #define WIFI_ACCESS_POINT_SSID					"ESP8266_AP_LED"
@@ -15,6 +34,33 @@
 #define WIFI_ACCESS_POINT_MAX_CONNECTIONS		3
 // TCP Server socket port number
 #define SERVER_SOCKET_PORT						1010
+// SDK server connection timeout (seconds). Set to maximum, as idle connections are reclaimed by connection table idle reaper.
+#define TCP_SERVER_SDK_TIMEOUT					7200
+// TCP keepalive probing of accepted connections: idle time before the first probe (seconds),
+// interval between probes (seconds) and number of unanswered probes before connection is dropped
+#ifndef TCP_KEEPALIVE_IDLE
+#define TCP_KEEPALIVE_IDLE						5
+#endif
+#ifndef TCP_KEEPALIVE_INTERVAL
+#define TCP_KEEPALIVE_INTERVAL					2
+#endif
+#ifndef TCP_KEEPALIVE_COUNT
+#define TCP_KEEPALIVE_COUNT						3
+#endif
+// Socket options profile applied to accepted connections:
+// default - lwIP defaults (Nagle algorithm on, sent callback after data is acknowledged) plus keepalive
+// low latency - Nagle algorithm off, sent callback as soon as data is copied to lwIP, so replies split over
+// several sends are not stalled by peer delayed ACK (up to 200ms)
+#define TCP_SOCKET_PROFILE_DEFAULT				0
+#define TCP_SOCKET_PROFILE_LOW_LATENCY			1
+#ifndef TCP_SOCKET_PROFILE
+#define TCP_SOCKET_PROFILE						TCP_SOCKET_PROFILE_LOW_LATENCY
+#endif
+
+// Per-segment receive message is logged for 1 in LOG_RECEIVE_SAMPLE segments
+#ifndef LOG_RECEIVE_SAMPLE
+#define LOG_RECEIVE_SAMPLE						8
+#endif
 
 // Baud rate which will be used for debug logs UART output
 #define UART_BAUD_RATE							115200
@@ -27,10 +73,11 @@
 #define STATE_CLIENT_WIFI_CONNECTED				1
 #define STATE_CLIENT_SOCKET_CONNECTED			2
 
-// Sets timer period interval in ticks for different events (1 tick - 100ms)
-#define TIMER_PERIOD_STATE_UPDATE				50
-#define TIMER_PERIOD_WIFI_STATUS_LED			5
-#define TIMER_PERIOD_RESET						1000000
+// Periods of scheduled tasks (ms). Nothing but housekeeping runs while no client is connected.
+// Housekeeping advances uptime and polls SDK station list, which only catches lost station events.
+#define TASK_PERIOD_HOUSEKEEPING				30000
+// Internal LED blink period, LED blinks only while client WiFi session has no socket connection
+#define TASK_PERIOD_STATUS_LED					500
 
 // System partitions sizes definition
 #define SYSTEM_PARTITION_RF_CAL_SZ				0x1000
@@ -45,29 +92,44 @@
 #define SYSTEM_PARTITION_PHY_DATA_ADDR			SYSTEM_SPI_SIZE - SYSTEM_PARTITION_SYSTEM_PARAMETER_SZ - SYSTEM_PARTITION_PHY_DATA_SZ
 #define SYSTEM_PARTITION_SYSTEM_PARAMETER_ADDR	SYSTEM_SPI_SIZE - SYSTEM_PARTITION_SYSTEM_PARAMETER_SZ
 
-// Input digit-chars range which will be processed by TCP Server
-static const char CHAR_DIGITS_START = '0';
-static const char CHAR_DIGITS_END = '7';
+// First digit-char of the range processed by TCP Server, outputs value is counted from it
+static const char CHAR_DIGITS_START = CMD_PARSER_DIGITS_START;
 // Internal LED GPIO pin
 static const uint8 GPIO_PIN_LED_INT = 2;
 // External LEDs GPIO pins
 static const uint8 GPIO_PIN_LED_1 = 12;
 static const uint8 GPIO_PIN_LED_2 = 13;
 static const uint8 GPIO_PIN_LED_3 = 14;
-// Timer used to refresh LEDs state bits
-static os_timer_t start_timer;
-// Timer invocation index number
-static uint32 tick_index = 0;
+// Single timer armed by deadline scheduler for the earliest task deadline
+static os_timer_t task_timer;
+// Scheduled tasks, reported by CMD_OPCODE_SCHED_QUERY under their SCHED_TASK_* ids
+static struct deadline_sched_task housekeeping_task;
+static struct deadline_sched_task conn_task;
+static struct deadline_sched_task status_led_task;
+#ifdef UART_DEBUG_LOGS
+static struct deadline_sched_task log_task;
+#endif
 // Indicates current connection state
 static uint8 client_connection_state = STATE_DISCONNECTED;
 // Holds ESP connection resource
 static struct espconn esp_conn;
 // Holds TCP server socket resource
 static esp_tcp esptcp;
-// Holds value of previously established WiFi sessions. Used for logging purposes.
-static uint8 prev_wifi_sessions_num = 0;
-// Indicates how many client TCP connections have been established
-static sint8 open_tcp_connections = 0;
+// Holds UDP listener connection resource
+static struct espconn udp_conn;
+// Holds UDP listener socket resource
+static esp_udp espudp;
+// Uptime accumulated from system time deltas, as system_get_time() wraps around every ~71 minutes
+static uint32 uptime_sec = 0;
+static uint32 uptime_us_rem = 0;
+static uint32 uptime_last_time = 0;
+// Entry time of receive callback which carries currently processed commands
+static uint32 command_received_at = 0;
+// Command receive to GPIO write latency (microseconds)
+static struct latency_hist command_latency;
+// Trace ring snapshot served by trace dump pages: sequence numbers of the first record and the number of records
+static uint32 trace_dump_start = 0;
+static uint16 trace_dump_records = 0;
 
 static const partition_item_t part_table[] =
 {
@@ -113,16 +175,16 @@ void access_point_dhcp_and_ip_setup(void)
 
 	if (wifi_softap_dhcps_start())
 	{
-		OS_UART_LOG("[INFO] AP DHCP Started\n");
+		OS_UART_LOG_INFO("AP DHCP Started\n");
 	}
 	else
 	{
-		OS_UART_LOG("[ERROR] Unable to start AP DHCP\n");
+		OS_UART_LOG_ERROR("Unable to start AP DHCP\n");
 	}
 }
 
 // ESP Access Point initialization. AP configuring.
-void access_point_setup(void)
+void access_point_setup(uint8 channel)
 {
 	if (ap_config != NULL)
 	{
@@ -138,93 +200,743 @@ void access_point_setup(void)
 	os_strcpy(ap_config->ssid, WIFI_ACCESS_POINT_SSID);
 	ap_config->ssid_len = 0;
 	os_strcpy(ap_config->password, WIFI_ACCESS_POINT_PASSPHRASE);
-	ap_config->channel = 10;
+	ap_config->channel = channel;
 
 	if (wifi_softap_set_config(ap_config))
 	{
-		OS_UART_LOG("[INFO] AP config is set\n");
+		OS_UART_LOG_INFO("AP config is set\n");
 		access_point_dhcp_and_ip_setup();
 	}
 	else
 	{
-		OS_UART_LOG("[ERROR] Unable to set Access Point configuration\n");
+		OS_UART_LOG_ERROR("Unable to set Access Point configuration\n");
 		access_point_release();
 	}
 }
 
+// Returns current LEDs state as 3-bit mask (bit 0 - first LED, bit 2 - last LED)
+uint8 get_output_mask(void)
+{
+	return (GPIO_REG_READ(GPIO_OUT_ADDRESS) >> GPIO_PIN_LED_1) & 0x07;
+}
+
+// Sets 3 LED pins in bulk according to 3-bit mask
+void set_output_mask(uint8 mask)
+{
+	gpio_output_set(0x07 << GPIO_PIN_LED_1, (mask ^ 0x07) << GPIO_PIN_LED_1, 0, 0);
+}
+
+// Accounts time passed since receive callback entry, called right after command GPIO write is completed
+LOCAL void ICACHE_FLASH_ATTR record_command_latency(void)
+{
+	latency_hist_add(&command_latency, system_get_time() - command_received_at);
+}
+
 // Method is used to set LEDs state according to the last 3 bits of input digit (e.g '7' - all LEDs are on, '5' - only the first and last LEDs are on, etc)
 void process_digit_key(char digit)
 {
 	uint8 num = (digit - CHAR_DIGITS_START) & 0x07;
-	OS_UART_LOG("[INFO] Processing digit-key: %d\n", num);
-	// Sets 3 LED pins in bulk
-	gpio_output_set(0x07 << GPIO_PIN_LED_1, (num ^ 0x07) << GPIO_PIN_LED_1, 0, 0);
+	OS_UART_LOG_DEBUG("Processing digit-key: %d\n", num);
+	set_output_mask(num);
+	record_command_latency();
+	trace_ring_write(TRACE_EV_DIGIT, num, 0);
+}
+
+// Applies batch of [op, mask] output operations in order. Batch is validated as a whole before the first operation is applied.
+LOCAL uint8 ICACHE_FLASH_ATTR process_output_batch(const uint8* ops, uint8 length, uint8* applied)
+{
+	uint8 idx;
+	*applied = 0;
+	if (length % CMD_OUTPUT_OP_SZ)
+	{
+		return CMD_STATUS_BAD_LENGTH;
+	}
+	for (idx = 0; idx < length; idx += CMD_OUTPUT_OP_SZ)
+	{
+		if (ops[idx] > CMD_OUTPUT_TOGGLE)
+		{
+			return CMD_STATUS_BAD_OPERATION;
+		}
+	}
+
+	uint8 mask = get_output_mask();
+	for (idx = 0; idx < length; idx += CMD_OUTPUT_OP_SZ)
+	{
+		switch (ops[idx])
+		{
+			case CMD_OUTPUT_WRITE:
+				mask = ops[idx + 1];
+				break;
+			case CMD_OUTPUT_SET:
+				mask |= ops[idx + 1];
+				break;
+			case CMD_OUTPUT_CLEAR:
+				mask &= ~ops[idx + 1];
+				break;
+			case CMD_OUTPUT_TOGGLE:
+				mask ^= ops[idx + 1];
+				break;
+		}
+		mask &= 0x07;
+		set_output_mask(mask);
+		(*applied)++;
+	}
+	if (*applied)
+	{
+		record_command_latency();
+	}
+	OS_UART_LOG_DEBUG("Applied %d output operations, outputs mask: %d\n", *applied, mask);
+	return CMD_STATUS_OK;
+}
+
+// Advances uptime counter. Has to be called at least once per system time wrap-around period.
+LOCAL uint32 ICACHE_FLASH_ATTR update_uptime(void)
+{
+	uint32 now = system_get_time();
+	uptime_us_rem += now - uptime_last_time;
+	uptime_last_time = now;
+	uptime_sec += uptime_us_rem / 1000000;
+	uptime_us_rem %= 1000000;
+	return uptime_sec;
+}
+
+// Blink task, scheduled only while client WiFi session has no socket connection
+LOCAL void ICACHE_FLASH_ATTR on_status_led_task(struct deadline_sched_task* task)
+{
+	(void)task;
+	if (GPIO_REG_READ(GPIO_OUT_ADDRESS) & (1 << GPIO_PIN_LED_INT))
+	{
+		gpio_output_set(0, (1 << GPIO_PIN_LED_INT), 0, 0);
+	}
+	else
+	{
+		gpio_output_set((1 << GPIO_PIN_LED_INT), 0, 0, 0);
+	}
+}
+
+// Sets internal LED according to connection state: off, blinking or on
+LOCAL void ICACHE_FLASH_ATTR update_status_led(void)
+{
+	if (client_connection_state == STATE_CLIENT_WIFI_CONNECTED)
+	{
+		if (!deadline_sched_pending(&status_led_task))
+		{
+			deadline_sched_every(&status_led_task, TASK_PERIOD_STATUS_LED * 1000);
+		}
+		return;
+	}
+	deadline_sched_cancel(&status_led_task);
+	if (client_connection_state == STATE_CLIENT_SOCKET_CONNECTED)
+	{
+		gpio_output_set(0, (1 << GPIO_PIN_LED_INT), 0, 0);
+	}
+	else
+	{
+		gpio_output_set((1 << GPIO_PIN_LED_INT), 0, 0, 0);
+	}
+}
+
+// Derives connection state from station and connection tables. Called whenever either of them changes,
+// so state and LED follow WiFi and socket events without polling delay.
+LOCAL void ICACHE_FLASH_ATTR update_connection_state(void)
+{
+	uint8 state = STATE_DISCONNECTED;
+	if (station_table_count())
+	{
+		state = conn_table_count() ? STATE_CLIENT_SOCKET_CONNECTED : STATE_CLIENT_WIFI_CONNECTED;
+	}
+	if (state != client_connection_state)
+	{
+		client_connection_state = state;
+		update_status_led();
+	}
+}
+
+// Fills CMD_OPCODE_STATE_QUERY reply payload. Served from memory only, so reads never touch UART.
+LOCAL uint8 ICACHE_FLASH_ATTR process_state_query(uint8* result)
+{
+	uint8* pos = result;
+	*pos++ = CMD_STATUS_OK;
+	*pos++ = get_output_mask();
+	*pos++ = client_connection_state;
+	*pos++ = station_table_count();
+	*pos++ = conn_table_count();
+	pos = cmd_frame_put_le32(pos, update_uptime());
+	pos = cmd_frame_put_le32(pos, system_get_free_heap_size());
+	return pos - result;
+}
+
+// Fills reply payload of failed command: [status, 0 applied operations, outputs mask]
+LOCAL uint8 ICACHE_FLASH_ATTR process_command_error(uint8* result, uint8 status)
+{
+	result[0] = status;
+	result[1] = 0;
+	result[2] = get_output_mask();
+	return 3;
+}
+
+// Fills CMD_OPCODE_LATENCY_QUERY reply payload. Percentiles are logged to UART only when requested by CMD_LATENCY_LOG flag.
+LOCAL uint8 ICACHE_FLASH_ATTR process_latency_query(uint8* result, uint8 flags)
+{
+	uint32 p50 = latency_hist_percentile(&command_latency, 500);
+	uint32 p90 = latency_hist_percentile(&command_latency, 900);
+	uint32 p99 = latency_hist_percentile(&command_latency, 990);
+	uint8* pos = result;
+	*pos++ = CMD_STATUS_OK;
+	pos = cmd_frame_put_le32(pos, command_latency.count);
+	pos = cmd_frame_put_le32(pos, p50);
+	pos = cmd_frame_put_le32(pos, p90);
+	pos = cmd_frame_put_le32(pos, p99);
+	pos = cmd_frame_put_le32(pos, command_latency.max);
+	if (flags & CMD_LATENCY_LOG)
+	{
+		OS_UART_LOG_INFO("Command latency (us), %d samples: p50 %d, p90 %d, p99 %d, max %d\n",
+				command_latency.count, p50, p90, p99, command_latency.max);
+	}
+	if (flags & CMD_LATENCY_RESET)
+	{
+		latency_hist_reset(&command_latency);
+	}
+	return pos - result;
+}
+
+// Fills CMD_OPCODE_COUNTERS_QUERY reply payload with server-wide or connection slot throughput counters
+LOCAL uint8 ICACHE_FLASH_ATTR process_counters_query(uint8* result, uint8 selector)
+{
+	struct conn_counters total;
+	struct conn_counters slots[CONN_TABLE_SIZE];
+	conn_table_snapshot(&total, slots);
+	if (selector != CMD_COUNTERS_TOTAL && selector >= CONN_TABLE_SIZE)
+	{
+		return process_command_error(result, CMD_STATUS_BAD_ARGUMENT);
+	}
+	const struct conn_counters* counters = selector == CMD_COUNTERS_TOTAL ? &total : &slots[selector];
+	uint8* pos = result;
+	uint8 idx;
+	*pos++ = CMD_STATUS_OK;
+	*pos++ = selector;
+	for (idx = 0; idx < CONN_COUNTERS_NUM; ++idx)
+	{
+		pos = cmd_frame_put_le32(pos, counters->values[idx]);
+	}
+	return pos - result;
+}
+
+// Fills CMD_OPCODE_MEMORY_QUERY reply payload with heap samples and stack high-water marks
+LOCAL uint8 ICACHE_FLASH_ATTR process_memory_query(uint8* result)
+{
+	const struct mem_watch_stats* stats = mem_watch_get_stats();
+	const struct mem_watch_event* last = NULL;
+	if (stats->low_water_events)
+	{
+		last = &stats->events[(stats->low_water_events - 1) % MEM_WATCH_EVENTS];
+	}
+	uint8* pos = result;
+	uint8 idx;
+	*pos++ = CMD_STATUS_OK;
+	pos = cmd_frame_put_le32(pos, stats->heap_current);
+	pos = cmd_frame_put_le32(pos, stats->heap_min);
+	pos = cmd_frame_put_le32(pos, stats->heap_avg);
+	pos = cmd_frame_put_le32(pos, stats->low_water_events);
+	pos = cmd_frame_put_le32(pos, last ? last->time : 0);
+	pos = cmd_frame_put_le32(pos, last ? last->free_heap : 0);
+	pos = cmd_frame_put_le16(pos, stats->stack_max);
+	for (idx = 0; idx < MEM_WATCH_CB_NUM; ++idx)
+	{
+		pos = cmd_frame_put_le16(pos, stats->stack_cb_max[idx]);
+	}
+	return pos - result;
+}
+
+// Fills CMD_OPCODE_TRACE_DUMP reply payload with single page of trace ring snapshot
+LOCAL uint8 ICACHE_FLASH_ATTR process_trace_dump(uint8* result, uint8 page)
+{
+	if (!page)
+	{
+		uint32 head = trace_ring_head();
+		trace_dump_records = head < TRACE_RING_RECORDS ? head : TRACE_RING_RECORDS;
+		trace_dump_start = head - trace_dump_records;
+	}
+	uint8 pages = (trace_dump_records + CMD_TRACE_PAGE_RECORDS - 1) / CMD_TRACE_PAGE_RECORDS;
+	if (page && page >= pages)
+	{
+		return process_command_error(result, CMD_STATUS_BAD_ARGUMENT);
+	}
+
+	uint32 first = trace_dump_start + page * CMD_TRACE_PAGE_RECORDS;
+	uint16 left = trace_dump_records - page * CMD_TRACE_PAGE_RECORDS;
+	uint8 records = left < CMD_TRACE_PAGE_RECORDS ? left : CMD_TRACE_PAGE_RECORDS;
+	uint8* pos = result + CMD_TRACE_HEADER_SZ;
+	uint8 idx;
+	result[0] = CMD_STATUS_OK;
+	for (idx = 0; idx < records; ++idx)
+	{
+		struct trace_record record;
+		if (!trace_ring_read(first + idx, &record))
+		{
+			// Page was overwritten by new records since the snapshot
+			result[0] = CMD_STATUS_TRACE_LOST;
+			records = 0;
+			pos = result + CMD_TRACE_HEADER_SZ;
+			break;
+		}
+		pos = cmd_frame_put_le32(pos, record.time);
+		*pos++ = record.event;
+		*pos++ = record.arg0;
+		pos = cmd_frame_put_le16(pos, record.arg1);
+	}
+	result[1] = page;
+	result[2] = pages;
+	result[3] = records;
+	cmd_frame_put_le32(result + 4, first);
+	return pos - result;
+}
+
+// Fills CMD_OPCODE_STATION_QUERY reply payload with station table content
+LOCAL uint8 ICACHE_FLASH_ATTR process_station_query(uint8* result)
+{
+	const struct station_table_stats* stats = station_table_get_stats();
+	uint8* pos = result;
+	uint8 idx;
+	*pos++ = CMD_STATUS_OK;
+	*pos++ = station_table_count();
+	pos = cmd_frame_put_le32(pos, stats->connects);
+	pos = cmd_frame_put_le32(pos, stats->disconnects);
+	pos = cmd_frame_put_le32(pos, stats->resyncs);
+	for (idx = 0; idx < STATION_TABLE_SIZE; ++idx)
+	{
+		const struct station_entry* entry = station_table_get(idx);
+		if (entry)
+		{
+			os_memcpy(pos, entry->mac, sizeof(entry->mac));
+			pos += sizeof(entry->mac);
+			*pos++ = entry->aid;
+			pos = cmd_frame_put_le32(pos, entry->connected_at);
+			pos = cmd_frame_put_le32(pos, entry->last_seen);
+		}
+	}
+	return pos - result;
+}
+
+// Fills CMD_OPCODE_CPU_QUERY reply payload with CPU frequency governor state
+LOCAL uint8 ICACHE_FLASH_ATTR process_cpu_query(uint8* result)
+{
+	const struct cpu_gov_stats* stats = cpu_gov_get_stats();
+	uint8* pos = result;
+	*pos++ = CMD_STATUS_OK;
+	*pos++ = stats->freq;
+	pos = cmd_frame_put_le32(pos, stats->switches_up);
+	pos = cmd_frame_put_le32(pos, stats->switches_down);
+	pos = cmd_frame_put_le32(pos, stats->ms_at_80);
+	pos = cmd_frame_put_le32(pos, stats->ms_at_160);
+	return pos - result;
+}
+
+// Fills CMD_OPCODE_CHANNEL_QUERY reply payload with the latest scan results and selected channel
+LOCAL uint8 ICACHE_FLASH_ATTR process_channel_query(uint8* result)
+{
+	const struct chan_select_stats* stats = chan_select_get_stats();
+	uint8* pos = result;
+	uint8 channel;
+	*pos++ = CMD_STATUS_OK;
+	*pos++ = stats->channel;
+	*pos++ = stats->aps_found;
+	pos = cmd_frame_put_le32(pos, stats->scans);
+	pos = cmd_frame_put_le32(pos, stats->scan_failures);
+	pos = cmd_frame_put_le32(pos, stats->migrations);
+	for (channel = 1; channel <= CHAN_SCORE_CHANNELS; ++channel)
+	{
+		*pos++ = stats->score.aps[channel - 1];
+		pos = cmd_frame_put_le16(pos, chan_score_get(&stats->score, channel));
+	}
+	return pos - result;
+}
+
+// Fills CMD_OPCODE_ADMISSION_QUERY reply payload with admission decisions and deferred aborts of rejected connections
+LOCAL uint8 ICACHE_FLASH_ATTR process_admission_query(uint8* result)
+{
+	const struct admission_stats* stats = admission_get_stats();
+	const struct conn_abort_stats* aborts = conn_abort_get_stats();
+	uint8* pos = result;
+	*pos++ = CMD_STATUS_OK;
+	*pos++ = stats->under_pressure;
+	pos = cmd_frame_put_le32(pos, stats->accepts);
+	pos = cmd_frame_put_le32(pos, stats->heap_rejects);
+	pos = cmd_frame_put_le32(pos, stats->connection_rejects);
+	pos = cmd_frame_put_le32(pos, stats->pressure_events);
+	pos = cmd_frame_put_le32(pos, stats->last_free_heap);
+	pos = cmd_frame_put_le32(pos, aborts->deferred);
+	pos = cmd_frame_put_le32(pos, aborts->aborted);
+	pos = cmd_frame_put_le32(pos, aborts->stale);
+	pos = cmd_frame_put_le32(pos, aborts->overflows);
+	return pos - result;
+}
+
+// Fills CMD_OPCODE_RECLAIM_QUERY reply payload with connection release counters by reason
+LOCAL uint8 ICACHE_FLASH_ATTR process_reclaim_query(uint8* result)
+{
+	const struct conn_table_stats* stats = conn_table_get_stats();
+	uint8* pos = result;
+	*pos++ = CMD_STATUS_OK;
+	pos = cmd_frame_put_le16(pos, CONN_IDLE_TIMEOUT_SEC);
+	pos = cmd_frame_put_le32(pos, stats->disconnects);
+	pos = cmd_frame_put_le32(pos, stats->idle_reclaims);
+	pos = cmd_frame_put_le32(pos, stats->keepalive_reclaims);
+	pos = cmd_frame_put_le32(pos, stats->error_reclaims);
+	pos = cmd_frame_put_le32(pos, stats->idle_reclaim_errors);
+	return pos - result;
+}
+
+// Fills CMD_OPCODE_SCHED_QUERY reply payload with scheduler wakeups and per task start jitter
+LOCAL uint8 ICACHE_FLASH_ATTR process_sched_query(uint8* result)
+{
+	const struct deadline_sched_stats* stats = deadline_sched_get_stats();
+	uint8* pos = result;
+	uint8 idx;
+	*pos++ = CMD_STATUS_OK;
+	pos = cmd_frame_put_le32(pos, stats->wakeups);
+	pos = cmd_frame_put_le32(pos, stats->early_wakeups);
+	uint8 count = deadline_sched_count();
+	if (count > CMD_SCHED_MAX_TASKS)
+	{
+		count = CMD_SCHED_MAX_TASKS;
+	}
+	*pos++ = count;
+	for (idx = 0; idx < count; ++idx)
+	{
+		const struct deadline_sched_task* task = deadline_sched_get(idx);
+		*pos++ = task->id;
+		pos = cmd_frame_put_le32(pos, task->jitter.runs);
+		pos = cmd_frame_put_le32(pos, task->jitter.runs ? (uint32)(task->jitter.sum / task->jitter.runs) : 0);
+		pos = cmd_frame_put_le32(pos, task->jitter.max);
+		pos = cmd_frame_put_le32(pos, task->jitter.overruns);
+	}
+	return pos - result;
+}
+
+#ifdef UART_DEBUG_LOGS
+// Fills CMD_OPCODE_LOG_SINK reply payload, selecting log sinks first if requested
+LOCAL uint8 ICACHE_FLASH_ATTR process_log_sink(uint8* result, const uint8* payload, uint8 length)
+{
+	if (length && (payload[0] & ~LOG_SINK_ALL))
+	{
+		return process_command_error(result, CMD_STATUS_BAD_ARGUMENT);
+	}
+	if (length)
+	{
+		log_sink_select(payload[0]);
+	}
+	const struct log_sink_stats* stats = log_sink_get_stats();
+	uint8* pos = result;
+	*pos++ = CMD_STATUS_OK;
+	*pos++ = log_sink_selected();
+	*pos++ = stats->subscribers;
+	pos = cmd_frame_put_le32(pos, stats->batches);
+	pos = cmd_frame_put_le32(pos, stats->bytes);
+	pos = cmd_frame_put_le32(pos, stats->dropped);
+	return pos - result;
+}
+#endif
+
+// Executes single binary command. Reply frame is queued to client transmit queue.
+LOCAL void ICACHE_FLASH_ATTR process_command_frame(struct conn_slot* client, const struct cmd_frame* frame)
+{
+	uint8 reply[CMD_FRAME_MAX_SZ];
+	uint8 result[CMD_FRAME_MAX_PAYLOAD];
+	uint8 result_length;
+	switch (frame->opcode)
+	{
+		case CMD_OPCODE_OUTPUT_BATCH:
+			// [status, applied operations, outputs mask]
+			result[0] = process_output_batch(frame->payload, frame->length, &result[1]);
+			result[2] = get_output_mask();
+			result_length = 3;
+			break;
+		case CMD_OPCODE_STATE_QUERY:
+			result_length = frame->length ? process_command_error(result, CMD_STATUS_BAD_LENGTH) : process_state_query(result);
+			break;
+		case CMD_OPCODE_LATENCY_QUERY:
+			result_length = frame->length > 1 ? process_command_error(result, CMD_STATUS_BAD_LENGTH)
+					: process_latency_query(result, frame->length ? frame->payload[0] : 0);
+			break;
+		case CMD_OPCODE_COUNTERS_QUERY:
+			result_length = frame->length > 1 ? process_command_error(result, CMD_STATUS_BAD_LENGTH)
+					: process_counters_query(result, frame->length ? frame->payload[0] : CMD_COUNTERS_TOTAL);
+			break;
+		case CMD_OPCODE_MEMORY_QUERY:
+			result_length = frame->length ? process_command_error(result, CMD_STATUS_BAD_LENGTH) : process_memory_query(result);
+			break;
+		case CMD_OPCODE_TRACE_DUMP:
+			result_length = frame->length > 1 ? process_command_error(result, CMD_STATUS_BAD_LENGTH)
+					: process_trace_dump(result, frame->length ? frame->payload[0] : 0);
+			break;
+		case CMD_OPCODE_STATION_QUERY:
+			result_length = frame->length ? process_command_error(result, CMD_STATUS_BAD_LENGTH) : process_station_query(result);
+			break;
+		case CMD_OPCODE_SCHED_QUERY:
+			result_length = frame->length ? process_command_error(result, CMD_STATUS_BAD_LENGTH) : process_sched_query(result);
+			break;
+		case CMD_OPCODE_CPU_QUERY:
+			result_length = frame->length ? process_command_error(result, CMD_STATUS_BAD_LENGTH) : process_cpu_query(result);
+			break;
+		case CMD_OPCODE_CHANNEL_QUERY:
+			result_length = frame->length ? process_command_error(result, CMD_STATUS_BAD_LENGTH) : process_channel_query(result);
+			break;
+		case CMD_OPCODE_ADMISSION_QUERY:
+			result_length = frame->length ? process_command_error(result, CMD_STATUS_BAD_LENGTH) : process_admission_query(result);
+			break;
+		case CMD_OPCODE_RECLAIM_QUERY:
+			result_length = frame->length ? process_command_error(result, CMD_STATUS_BAD_LENGTH) : process_reclaim_query(result);
+			break;
+#ifdef UART_DEBUG_LOGS
+		case CMD_OPCODE_LOG_SINK:
+			result_length = frame->length > 1 ? process_command_error(result, CMD_STATUS_BAD_LENGTH)
+					: process_log_sink(result, frame->payload, frame->length);
+			break;
+#endif
+		default:
+			OS_UART_LOG_WARN("Unknown command opcode: %d\n", frame->opcode);
+			result_length = process_command_error(result, CMD_STATUS_BAD_OPCODE);
+			break;
+	}
+	uint16 reply_length = cmd_frame_encode(reply, frame->opcode | CMD_OPCODE_REPLY, frame->seq, result, result_length);
+	if (!tx_queue_push(&client->tx, reply, reply_length))
+	{
+		OS_UART_LOG_WARN("Transmit queue is full, reply to command frame %d dropped\n", frame->seq);
+	}
+}
+
+// Releases connection slot on disconnect or error
+LOCAL void ICACHE_FLASH_ATTR release_connection(struct espconn* pesp_conn, uint8 reason)
+{
+	struct conn_slot* client = conn_table_lookup(pesp_conn);
+	if (client)
+	{
+		OS_UART_LOG_INFO("Client TX: %d bytes, %d sends, %d coalesced, %d queue full, %d send errors\n",
+				client->tx.bytes, client->tx.sends, client->tx.coalesced, client->tx.queue_full, client->tx.send_errors);
+		conn_table_add_counter(client, reason == CONN_RELEASE_DISCONNECT ? CONN_COUNTER_DISCONNECTS : CONN_COUNTER_RECONNECT_ERRORS, 1);
+		if (reason == CONN_RELEASE_DISCONNECT)
+		{
+			trace_ring_write(TRACE_EV_DISCONNECT, client->index, 0);
+		}
+		conn_table_release(client, reason);
+		update_connection_state();
+#if LOG_ENABLED(LOG_LEVEL_INFO)
+		const struct conn_table_stats* stats = conn_table_get_stats();
+		OS_UART_LOG_INFO("Reclaimed connections: %d disconnects, %d idle, %d keepalive, %d errors\n",
+				stats->disconnects, stats->idle_reclaims, stats->keepalive_reclaims, stats->error_reclaims);
+#endif
+	}
+	else
+	{
+		OS_UART_LOG_WARN("Released connection is not found in connection table\n");
+	}
 }
 
 // This callback method is triggered when server receives data from client
 LOCAL void ICACHE_FLASH_ATTR on_tcp_server_receive(void* arg, char* pusrdata, unsigned short length)
 {
-	OS_UART_LOG("[INFO] TCP Server 'on data received' event. Received %d bytes.\n", length);
-	// In case of logs are enabled - will try to print received package content to UART
-#ifdef UART_DEBUG_LOGS
-	char* pstr_buf = (char*)os_zalloc(length + 1);
-	os_memcpy(pstr_buf, pusrdata, length);
-	pstr_buf[length] = 0;
-	OS_UART_LOG("[INFO] Received package content:\n%s\n", pstr_buf);
-	os_free(pstr_buf);
+	command_received_at = system_get_time();
+	struct espconn* pesp_conn = arg;
+	struct conn_slot* client = conn_table_lookup(pesp_conn);
+	uint8 trace_slot = client ? client->index : 0xFF;
+	trace_ring_write(TRACE_EV_RECV, trace_slot, length);
+	OS_UART_LOG_DEBUG_SAMPLED(LOG_RECEIVE_SAMPLE, "TCP Server 'on data received' event. Received %d bytes.\n", length);
+	// In case of logs are enabled - will print bounded dump of received package content to UART
+#if LOG_ENABLED(LOG_LEVEL_DEBUG)
+	dump_payload(pusrdata, length);
 #endif
-	if (length)
+	if (!client)
+	{
+		OS_UART_LOG_WARN("Connection is not found in connection table, %d bytes dropped\n", length);
+		trace_ring_write(TRACE_EV_RECV | TRACE_EVENT_END, trace_slot, 0);
+		mem_watch_check_stack(MEM_WATCH_CB_TCP_RECV);
+		return;
+	}
+	conn_table_touch(client);
+	conn_table_add_counter(client, CONN_COUNTER_RX_BYTES, length);
+	conn_table_add_counter(client, CONN_COUNTER_RX_CALLBACKS, 1);
+
+	// Every complete command is applied once in order of arrival, regardless of segments boundaries
+	const uint8* data = (const uint8*)pusrdata;
+	struct cmd_parser_command command;
+	uint16 consumed;
+	while (length)
 	{
-		char last_char = 0;
-		unsigned short idx;
-		for (idx = length; idx > 0 && !last_char; --idx)
+		switch (cmd_parser_next(&client->parser, data, length, &consumed, &command))
 		{
-			last_char = pusrdata[idx - 1];
-			if (last_char >= CHAR_DIGITS_START && last_char <= CHAR_DIGITS_END)
-			{
-				process_digit_key(last_char);
-			}
-			else
-			{
-				last_char = 0;
-			}
+			case CMD_PARSER_DIGIT:
+				process_digit_key(command.digit);
+				conn_table_add_counter(client, CONN_COUNTER_COMMANDS, 1);
+				break;
+			case CMD_PARSER_FRAME:
+				process_command_frame(client, &command.frame);
+				conn_table_add_counter(client, CONN_COUNTER_COMMANDS, 1);
+				break;
+			case CMD_PARSER_ERROR:
+				OS_UART_LOG_WARN("Corrupted command frame dropped\n");
+				break;
+		}
+		if (command.ignored)
+		{
+			conn_table_add_counter(client, CONN_COUNTER_IGNORED_BYTES, command.ignored);
 		}
+		data += consumed;
+		length -= consumed;
+	}
+
+	// Replies generated by the whole segment leave in as few sends as possible
+	tx_queue_flush(&client->tx);
+	cpu_gov_account_receive(command_received_at);
+	trace_ring_write(TRACE_EV_RECV | TRACE_EVENT_END, trace_slot, 0);
+	mem_watch_check_stack(MEM_WATCH_CB_TCP_RECV);
+}
+
+// This callback method is triggered when data passed to espconn_send has been sent
+LOCAL void ICACHE_FLASH_ATTR on_tcp_server_sent(void* arg)
+{
+	struct espconn* pesp_conn = arg;
+	struct conn_slot* client = conn_table_lookup(pesp_conn);
+	if (client)
+	{
+		tx_queue_on_sent(&client->tx);
 	}
+	mem_watch_check_stack(MEM_WATCH_CB_TCP_SENT);
 }
 
 // This callback method is triggered when client reconnects to the server due to some issues
 LOCAL void ICACHE_FLASH_ATTR on_tcp_server_reconnect(void *arg, sint8 err)
 {
 	struct espconn *pesp_conn = arg;
-	OS_UART_LOG("[WARN] TCP Server %d.%d.%d.%d:%d err %d 'on reconnect' event\n", pesp_conn->proto.tcp->remote_ip[0],
+	OS_UART_LOG_WARN("TCP Server %d.%d.%d.%d:%d err %d 'on reconnect' event\n", pesp_conn->proto.tcp->remote_ip[0],
 					pesp_conn->proto.tcp->remote_ip[1],pesp_conn->proto.tcp->remote_ip[2],
 					pesp_conn->proto.tcp->remote_ip[3],pesp_conn->proto.tcp->remote_port, err);
+	// Keepalive failure is reported as abort/timeout of connection which stayed silent for at least keepalive idle time
+	struct conn_slot* client = conn_table_lookup(pesp_conn);
+	trace_ring_write(TRACE_EV_RECONNECT, client ? client->index : 0xFF, (uint16)err);
+	uint8 reason = CONN_RELEASE_ERROR;
+	if (client && (err == ESPCONN_TIMEOUT || err == ESPCONN_ABRT)
+			&& system_get_time() - client->last_rx_at >= TCP_KEEPALIVE_IDLE * 1000000U)
+	{
+		reason = CONN_RELEASE_KEEPALIVE;
+	}
+	release_connection(pesp_conn, reason);
 }
 
 // This callback method is triggered when client becomes disconnected from server
 LOCAL void ICACHE_FLASH_ATTR on_tcp_server_disconnect(void *arg)
 {
 	struct espconn *pesp_conn = arg;
-	OS_UART_LOG("[INFO] TCP Server %d.%d.%d.%d:%d 'on disconnect' event\n", pesp_conn->proto.tcp->remote_ip[0],
+	OS_UART_LOG_INFO("TCP Server %d.%d.%d.%d:%d 'on disconnect' event\n", pesp_conn->proto.tcp->remote_ip[0],
 					pesp_conn->proto.tcp->remote_ip[1],pesp_conn->proto.tcp->remote_ip[2],
 					pesp_conn->proto.tcp->remote_ip[3],pesp_conn->proto.tcp->remote_port);
-	open_tcp_connections--;
+	release_connection(pesp_conn, CONN_RELEASE_DISCONNECT);
+}
+
+// Applies socket options of TCP_SOCKET_PROFILE. TCP keepalive probing is enabled in every profile,
+// so that peers vanished without FIN are detected within seconds.
+LOCAL void ICACHE_FLASH_ATTR apply_socket_profile(struct espconn* pesp_conn)
+{
+#if TCP_SOCKET_PROFILE == TCP_SOCKET_PROFILE_LOW_LATENCY
+	uint8 options = ESPCONN_REUSEADDR | ESPCONN_NODELAY | ESPCONN_COPY | ESPCONN_KEEPALIVE;
+#else
+	uint8 options = ESPCONN_KEEPALIVE;
+#endif
+	uint32 keep_idle = TCP_KEEPALIVE_IDLE;
+	uint32 keep_interval = TCP_KEEPALIVE_INTERVAL;
+	uint32 keep_count = TCP_KEEPALIVE_COUNT;
+	if (espconn_set_opt(pesp_conn, options) != ESPCONN_OK
+			|| espconn_set_keepalive(pesp_conn, ESPCONN_KEEPIDLE, &keep_idle) != ESPCONN_OK
+			|| espconn_set_keepalive(pesp_conn, ESPCONN_KEEPINTVL, &keep_interval) != ESPCONN_OK
+			|| espconn_set_keepalive(pesp_conn, ESPCONN_KEEPCNT, &keep_count) != ESPCONN_OK)
+	{
+		OS_UART_LOG_WARN("Unable to apply socket options profile to accepted connection\n");
+	}
+}
+
+// Idle reaper callback: closes connection which has not sent anything for CONN_IDLE_TIMEOUT_SEC
+LOCAL void ICACHE_FLASH_ATTR reclaim_idle_connection(struct conn_slot* client)
+{
+	if (espconn_disconnect(client->conn) != ESPCONN_OK)
+	{
+		// Connection is already gone without callback, slot is reclaimed right away and accounted as error
+		conn_table_add_counter(client, CONN_COUNTER_RECONNECT_ERRORS, 1);
+		conn_table_release(client, CONN_RELEASE_ERROR);
+		update_connection_state();
+	}
+}
+
+// Connection housekeeping task, runs every CONN_TABLE_TICK_MS while any connection is open
+LOCAL void ICACHE_FLASH_ATTR on_conn_task(struct deadline_sched_task* task)
+{
+	(void)task;
+	// Reclaims idle connections
+	conn_table_tick(reclaim_idle_connection);
+
+	// Retries transmit queues which failed to send while nothing was in flight
+	uint8 idx;
+	for (idx = 0; idx < CONN_TABLE_SIZE; ++idx)
+	{
+		struct conn_slot* client = conn_table_get(idx);
+		if (client)
+		{
+			tx_queue_flush(&client->tx);
+		}
+	}
+
+	// Heap is sampled every tick while connections are open, so short allocation peaks are not missed
+	mem_watch_sample_heap(conn_table_count());
+	if (!conn_table_count())
+	{
+		deadline_sched_cancel(task);
+	}
 }
 
 // This callback method is triggered when client's connection is accepted by server
 LOCAL void ICACHE_FLASH_ATTR on_tcp_server_accepted(void *arg)
 {
-	OS_UART_LOG("[INFO] TCP Server 'on client connection accepted' event\n");
 	struct espconn *pesp_conn = arg;
+	trace_ring_write(TRACE_EV_ACCEPT, 0, pesp_conn->proto.tcp->remote_port);
+	OS_UART_LOG_DEBUG("TCP Server 'on client connection accepted' event\n");
+	// Connections over budget or under heap pressure are reset right away, before any resource is taken for them
+	uint8 admission = admission_check(conn_table_count(), CONN_TABLE_SIZE);
+	struct conn_slot* client = admission == ADMISSION_ACCEPT ? conn_table_acquire(pesp_conn) : NULL;
+	if (!client)
+	{
+#if LOG_ENABLED(LOG_LEVEL_WARN)
+		const struct admission_stats* stats = admission_get_stats();
+		OS_UART_LOG_WARN("Connection rejected (%s), free heap: %d, rejects: %d heap, %d connections\n",
+				admission == ADMISSION_REJECT_HEAP ? "heap" : "connections", stats->last_free_heap,
+				stats->heap_rejects, stats->connection_rejects);
+#endif
+		// Rejected connection has no callbacks registered, it is reset once this callback returns
+		if (!conn_abort_defer(pesp_conn))
+		{
+			OS_UART_LOG_WARN("Abort queue is full, rejected connection is left to SDK timeout\n");
+		}
+		trace_ring_write(TRACE_EV_ACCEPT | TRACE_EVENT_END, 0xFF, 0);
+		mem_watch_check_stack(MEM_WATCH_CB_TCP_ACCEPT);
+		return;
+	}
+	conn_table_add_counter(client, CONN_COUNTER_ACCEPTS, 1);
 	espconn_regist_recvcb(pesp_conn, on_tcp_server_receive);
+	espconn_regist_sentcb(pesp_conn, on_tcp_server_sent);
 	espconn_regist_reconcb(pesp_conn, on_tcp_server_reconnect);
 	espconn_regist_disconcb(pesp_conn, on_tcp_server_disconnect);
-	open_tcp_connections++;
+	apply_socket_profile(pesp_conn);
+	if (!deadline_sched_pending(&conn_task))
+	{
+		deadline_sched_every(&conn_task, CONN_TABLE_TICK_MS * 1000);
+	}
+	update_connection_state();
+	trace_ring_write(TRACE_EV_ACCEPT | TRACE_EVENT_END, client->index, 0);
+	mem_watch_check_stack(MEM_WATCH_CB_TCP_ACCEPT);
 }
 
 // This method makes a setup of TCP server to listen for client connections
 void tcp_server_setup(void)
 {
+	conn_table_init();
 	esp_conn.type = ESPCONN_TCP;
 	esp_conn.state = ESPCONN_NONE;
 	esp_conn.proto.tcp = &esptcp;
@@ -233,105 +945,208 @@ void tcp_server_setup(void)
 	sint8 res = espconn_accept(&esp_conn);
 	if (res == ESPCONN_OK)
 	{
-		OS_UART_LOG("[INFO] TCP Server accepts connections on port %d\n", SERVER_SOCKET_PORT);
+		OS_UART_LOG_INFO("TCP Server accepts connections on port %d\n", SERVER_SOCKET_PORT);
+		// lwIP itself refuses connections over connection table capacity
+		espconn_tcp_set_max_con_allow(&esp_conn, CONN_TABLE_SIZE);
 	}
 	else
 	{
-#ifdef UART_DEBUG_LOGS
+#if LOG_ENABLED(LOG_LEVEL_ERROR)
 		char state_str[250];
 		lookup_espconn_error(state_str, res);
-		OS_UART_LOG("[ERROR] Unable set TCP Server to accept connections: %s\n", state_str);
+		OS_UART_LOG_ERROR("Unable set TCP Server to accept connections: %s\n", state_str);
 #endif
 	}
-	// Increased client connection timeout (set to 1 minute)
-	espconn_regist_time(&esp_conn, 60, 0);
+	// SDK client connection timeout is kept only as a backstop for connection table idle reaper
+	espconn_regist_time(&esp_conn, TCP_SERVER_SDK_TIMEOUT, 0);
 }
 
-// Timer callback method. Triggered 10 times per second.
-void on_timer(void* arg)
+// This callback method is triggered for every datagram received by UDP listener
+LOCAL void ICACHE_FLASH_ATTR on_udp_server_receive(void* arg, char* pusrdata, unsigned short length)
 {
-	// WiFi client_connection_state variable update
-	if (tick_index % TIMER_PERIOD_STATE_UPDATE == 0)
+	command_received_at = system_get_time();
+	trace_ring_write(TRACE_EV_UDP_RECV, 0, length);
+	struct espconn* pesp_conn = arg;
+	remot_info* remote = NULL;
+	uint8 digit;
+	// SDK does not fill proto.udp remote fields on receive, sender is reported by connection info only
+	if (espconn_get_connection_info(pesp_conn, &remote, 0) != ESPCONN_OK)
 	{
-		uint8 wifi_sessions_num = wifi_softap_get_station_num();
-
-		if (wifi_sessions_num != prev_wifi_sessions_num)
+		OS_UART_LOG_WARN("UDP command sender is unknown, datagram dropped\n");
+	}
+	else
+	{
+		switch (udp_command_process((const uint8*)pusrdata, length, remote->remote_ip, remote->remote_port, &digit))
 		{
-			OS_UART_LOG("[INFO] Number of connected WiFi sessions: %d\n", wifi_sessions_num);
-			prev_wifi_sessions_num = wifi_sessions_num;
+			case UDP_COMMAND_APPLY:
+				process_digit_key(digit);
+				break;
+			case UDP_COMMAND_STALE:
+				OS_UART_LOG_WARN("Stale UDP command dropped, %d dropped so far\n", udp_command_get_stats()->stale);
+				break;
+			case UDP_COMMAND_MALFORMED:
+				OS_UART_LOG_WARN("Malformed UDP command dropped\n");
+				break;
 		}
+	}
+	cpu_gov_account_receive(command_received_at);
+	trace_ring_write(TRACE_EV_UDP_RECV | TRACE_EVENT_END, 0, 0);
+	mem_watch_check_stack(MEM_WATCH_CB_UDP_RECV);
+}
 
-		if (wifi_sessions_num)
-		{
-			if (open_tcp_connections)
-			{
-				client_connection_state = STATE_CLIENT_SOCKET_CONNECTED;
-			}
-			else
-			{
-				client_connection_state = STATE_CLIENT_WIFI_CONNECTED;
-			}
-		}
-		else
-		{
-			client_connection_state = STATE_DISCONNECTED;
-			open_tcp_connections = 0;
-		}
+// This method makes a setup of UDP listener, which accepts digit commands on the same port as TCP server
+void udp_server_setup(void)
+{
+	udp_conn.type = ESPCONN_UDP;
+	udp_conn.state = ESPCONN_NONE;
+	udp_conn.proto.udp = &espudp;
+	udp_conn.proto.udp->local_port = SERVER_SOCKET_PORT;
+	espconn_regist_recvcb(&udp_conn, on_udp_server_receive);
+	sint8 res = espconn_create(&udp_conn);
+	if (res == ESPCONN_OK)
+	{
+		OS_UART_LOG_INFO("UDP listener accepts commands on port %d\n", SERVER_SOCKET_PORT);
 	}
+	else
+	{
+#if LOG_ENABLED(LOG_LEVEL_ERROR)
+		char state_str[250];
+		lookup_espconn_error(state_str, res);
+		OS_UART_LOG_ERROR("Unable to create UDP listener: %s\n", state_str);
+#endif
+	}
+}
 
-	// WiFi status LED indication update
-	if (tick_index % TIMER_PERIOD_WIFI_STATUS_LED == 0)
+// WiFi event callback. Station table and connection state follow soft-AP events as they come.
+LOCAL void ICACHE_FLASH_ATTR on_wifi_event(System_Event_t* event)
+{
+	uint32 now = update_uptime();
+	switch (event->event)
 	{
-		if (client_connection_state == STATE_CLIENT_SOCKET_CONNECTED)
+		case EVENT_SOFTAPMODE_STACONNECTED:
 		{
-			gpio_output_set(0, (1 << GPIO_PIN_LED_INT), 0, 0);
+			const Event_SoftAPMode_StaConnected_t* info = &event->event_info.sta_connected;
+			station_table_connected(info->mac, info->aid, now);
+			OS_UART_LOG_INFO("Station %02x:%02x:%02x:%02x:%02x:%02x connected, aid %d, %d stations\n",
+					info->mac[0], info->mac[1], info->mac[2], info->mac[3], info->mac[4], info->mac[5],
+					info->aid, station_table_count());
+			break;
 		}
-		else if (client_connection_state == STATE_CLIENT_WIFI_CONNECTED)
+		case EVENT_SOFTAPMODE_STADISCONNECTED:
 		{
-			if (GPIO_REG_READ(GPIO_OUT_ADDRESS) & (1 << GPIO_PIN_LED_INT))
+			const Event_SoftAPMode_StaDisconnected_t* info = &event->event_info.sta_disconnected;
+			if (station_table_disconnected(info->mac))
 			{
-				gpio_output_set(0, (1 << GPIO_PIN_LED_INT), 0, 0);
+				OS_UART_LOG_INFO("Station %02x:%02x:%02x:%02x:%02x:%02x disconnected, aid %d, %d stations\n",
+						info->mac[0], info->mac[1], info->mac[2], info->mac[3], info->mac[4], info->mac[5],
+						info->aid, station_table_count());
 			}
 			else
 			{
-				gpio_output_set((1 << GPIO_PIN_LED_INT), 0, 0, 0);
+				OS_UART_LOG_WARN("Disconnected station aid %d is not found in station table\n", info->aid);
 			}
+			break;
 		}
-		else
-		{
-			gpio_output_set((1 << GPIO_PIN_LED_INT), 0, 0, 0);
-		}
+		case EVENT_SOFTAPMODE_PROBEREQRECVED:
+			station_table_seen(event->event_info.ap_probereqrecved.mac, now);
+			return;
+		default:
+			return;
 	}
+	update_connection_state();
+}
 
-	tick_index++;
-	if (tick_index >= TIMER_PERIOD_RESET)
+// Housekeeping task, the only one which runs while no client is connected
+LOCAL void ICACHE_FLASH_ATTR on_housekeeping_task(struct deadline_sched_task* task)
+{
+	(void)task;
+	// Uptime has to be advanced at least once per system time wrap-around
+	update_uptime();
+	// Catches station events which were lost
+	if (station_table_check(uptime_sec))
 	{
-		tick_index = 0;
+		OS_UART_LOG_INFO("Station table resynced, %d stations\n", station_table_count());
 	}
+	update_connection_state();
+	mem_watch_sample_heap(conn_table_count());
+	cpu_gov_update_time();
 }
 
-// Callback method is triggered upon ESP initialization completion
-void on_user_init_completed(void)
+#ifdef UART_DEBUG_LOGS
+// Log output housekeeping task: restarts UART drain, reports suppressed messages and flushes network log batch
+LOCAL void ICACHE_FLASH_ATTR on_log_task(struct deadline_sched_task* task)
 {
-	access_point_setup();
+	(void)task;
+	uart_log_poll();
+	log_rate_poll();
+	log_sink_poll();
+}
+#endif
+
+// Timer callback method. Timer is armed by deadline scheduler for the earliest task deadline only.
+void on_timer(void* arg)
+{
+	(void)arg;
+	trace_ring_write(TRACE_EV_TIMER, 0, (uint16)deadline_sched_get_stats()->wakeups);
+	uint8 runs = deadline_sched_run();
+	trace_ring_write(TRACE_EV_TIMER | TRACE_EVENT_END, runs, 0);
+	mem_watch_check_stack(MEM_WATCH_CB_TIMER);
+}
+
+// Access point can move to another channel only while no TCP client is connected
+LOCAL bool ICACHE_FLASH_ATTR access_point_idle(void)
+{
+	return conn_table_count() == 0;
+}
+
+// Channel selection callback: brings access point up on selected channel, servers are started at boot only
+LOCAL void ICACHE_FLASH_ATTR on_channel_selected(uint8 channel, bool migration)
+{
+	access_point_setup(channel);
+	if (migration)
+	{
+		return;
+	}
 	struct ip_info info;
 	wifi_get_ip_info(SOFTAP_IF, &info);
-	OS_UART_LOG("[INFO] AP Host IP: %d.%d.%d.%d\n",
+	OS_UART_LOG_INFO("AP Host IP: %d.%d.%d.%d\n",
 			*((uint8*) &info.ip.addr),
 			*((uint8*)&info.ip.addr+1),
 			*((uint8*)&info.ip.addr+2),
 			*((uint8*)&info.ip.addr+3));
-	OS_UART_LOG("[INFO] ESP Access Point initialization is completed\n");
+	OS_UART_LOG_INFO("ESP Access Point initialization is completed\n");
 	tcp_server_setup();
-	os_timer_setfn(&start_timer, (os_timer_func_t*)on_timer, NULL);
-	os_timer_arm(&start_timer, 100, 1);
+	udp_server_setup();
+#ifdef UART_DEBUG_LOGS
+	log_sink_listen();
+#endif
+	deadline_sched_every(&housekeeping_task, TASK_PERIOD_HOUSEKEEPING * 1000);
+#ifdef UART_DEBUG_LOGS
+	deadline_sched_every(&log_task, LOG_SINK_FLUSH_MS * 1000);
+#endif
+	mem_watch_check_stack(MEM_WATCH_CB_INIT_DONE);
+}
+
+// Callback method is triggered upon ESP initialization completion
+void on_user_init_completed(void)
+{
+	// Access point comes up once the least congested channel is found by scan
+	chan_select_start(on_channel_selected, access_point_idle);
+	mem_watch_check_stack(MEM_WATCH_CB_INIT_DONE);
 }
 
 // Main user initialization method
 void ICACHE_FLASH_ATTR user_init(void)
 {
+	// Stack area below user_init frame is painted first, so its high-water marks can be tracked
+	mem_watch_init();
 	// UART output initialization for logging output
 	uart_init(UART_BAUD_RATE, UART_BAUD_RATE);
+#ifdef UART_DEBUG_LOGS
+	// Log output is buffered and drained by UART interrupt, so logging never stalls callbacks
+	uart_log_init();
+	log_sink_init();
+#endif
 	// LEDs pins initialization
 	gpio_init();
 	PIN_FUNC_SELECT(PERIPHS_IO_MUX_GPIO2_U, FUNC_GPIO2);
@@ -342,8 +1157,22 @@ void ICACHE_FLASH_ATTR user_init(void)
 	gpio_output_set(0, 0, (1 << GPIO_PIN_LED_1), 0);
 	gpio_output_set(0, 0, (1 << GPIO_PIN_LED_2), 0);
 	gpio_output_set(0, 0, (1 << GPIO_PIN_LED_3), 0);
-	// Sets ESP to access point mode
-	wifi_set_opmode(SOFTAP_MODE);
+	// Periodic work runs as deadline scheduler tasks, timer wakes up only when the earliest of them is due
+	os_timer_setfn(&task_timer, (os_timer_func_t*)on_timer, NULL);
+	deadline_sched_init(&task_timer);
+	deadline_sched_register(&housekeeping_task, SCHED_TASK_HOUSEKEEPING, on_housekeeping_task);
+	deadline_sched_register(&conn_task, SCHED_TASK_CONN, on_conn_task);
+	deadline_sched_register(&status_led_task, SCHED_TASK_STATUS_LED, on_status_led_task);
+	// Connections rejected from accept callbacks are aborted from user task
+	conn_abort_init();
+	// CPU frequency governor registers its load sampling task
+	cpu_gov_init();
+#ifdef UART_DEBUG_LOGS
+	deadline_sched_register(&log_task, SCHED_TASK_LOG, on_log_task);
+#endif
+	// Station interface is enabled for boot channel scan, ESP is set to access point mode once it is done
+	wifi_set_opmode_current(STATIONAP_MODE);
+	wifi_set_event_handler_cb(on_wifi_event);
 	// on_user_init_completed callback triggered upon initialization is completed
 	system_init_done_cb(on_user_init_completed);
 }
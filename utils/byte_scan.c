@@ -0,0 +1,161 @@
+#include "byte_scan.h"
+
+// Allows reading byte buffers through 32-bit words without breaking strict aliasing rules
+typedef uint32 __attribute__((__may_alias__)) uint32_word;
+
+#define WORD_SZ								sizeof(uint32)
+#define BYTES_LOW7							0x7F7F7F7FU
+#define BYTES_HIGH							0x80808080U
+#define BYTES_ONES							0x01010101U
+// Buffers shorter than this are scanned byte by byte, word setup does not pay off for them
+#define SWAR_MIN_LENGTH						16
+
+// Returns mask with 0x80 set in every byte of word which lies within [lo, hi] range.
+// Adding (0x80 - bound) to the low 7 bits of each byte sets its high bit when byte >= bound, without carries between bytes.
+static inline uint32 word_range_mask(uint32 word, uint32 add_lo, uint32 add_hi)
+{
+	uint32 low7 = word & BYTES_LOW7;
+	uint32 ge_lo = low7 + add_lo;
+	uint32 gt_hi = low7 + add_hi;
+	return ge_lo & ~gt_hi & ~word & BYTES_HIGH;
+}
+
+// Returns mask with 0x80 set in every zero byte of word (exact, no false positives)
+static inline uint32 word_zero_mask(uint32 word)
+{
+	uint32 t = (word & BYTES_LOW7) + BYTES_LOW7;
+	return ~(t | word | BYTES_LOW7);
+}
+
+sint32 ICACHE_FLASH_ATTR byte_scan_last_in_range(const uint8* data, uint16 length, uint8 lo, uint8 hi)
+{
+	// Range check as single unsigned comparison
+	uint8 span = hi - lo;
+	sint32 idx = length;
+
+	// Short buffers take plain loop, without alignment and word mask setup
+	if (length < SWAR_MIN_LENGTH)
+	{
+		while (--idx >= 0 && (uint8)(data[idx] - lo) > span)
+		{
+		}
+		return idx;
+	}
+	uint32 add_lo = (0x80 - lo) * BYTES_ONES;
+	uint32 add_hi = (0x80 - (hi + 1)) * BYTES_ONES;
+	uint16 head = (WORD_SZ - ((size_t)data & (WORD_SZ - 1))) & (WORD_SZ - 1);
+	// Tail bytes following the last aligned word
+	while (idx > head && ((idx - head) & (WORD_SZ - 1)))
+	{
+		--idx;
+		if (data[idx] >= lo && data[idx] <= hi)
+		{
+			return idx;
+		}
+	}
+	// Aligned words, little-endian: the highest matching byte is the last one
+	while (idx > head)
+	{
+		idx -= WORD_SZ;
+		uint32 mask = word_range_mask(*(const uint32_word*)(data + idx), add_lo, add_hi);
+		if (mask)
+		{
+			return idx + ((31 - __builtin_clz(mask)) >> 3);
+		}
+	}
+	// Unaligned head bytes
+	while (idx > 0)
+	{
+		--idx;
+		if (data[idx] >= lo && data[idx] <= hi)
+		{
+			return idx;
+		}
+	}
+	return -1;
+}
+
+uint16 ICACHE_FLASH_ATTR byte_scan_first_in_range(const uint8* data, uint16 length, uint8 lo, uint8 hi)
+{
+	// Range check as single unsigned comparison
+	uint8 span = hi - lo;
+	uint16 idx = 0;
+
+	// Short buffers take plain loop, without alignment and word mask setup
+	if (length < SWAR_MIN_LENGTH)
+	{
+		while (idx < length && (uint8)(data[idx] - lo) > span)
+		{
+			++idx;
+		}
+		return idx;
+	}
+	uint32 add_lo = (0x80 - lo) * BYTES_ONES;
+	uint32 add_hi = (0x80 - (hi + 1)) * BYTES_ONES;
+	// Unaligned head bytes
+	while (idx < length && ((size_t)(data + idx) & (WORD_SZ - 1)))
+	{
+		if ((uint8)(data[idx] - lo) <= span)
+		{
+			return idx;
+		}
+		++idx;
+	}
+	// Aligned words, little-endian: the lowest matching byte is the first one
+	while (idx + WORD_SZ <= length)
+	{
+		uint32 mask = word_range_mask(*(const uint32_word*)(data + idx), add_lo, add_hi);
+		if (mask)
+		{
+			return idx + (__builtin_ctz(mask) >> 3);
+		}
+		idx += WORD_SZ;
+	}
+	// Tail bytes
+	while (idx < length && (uint8)(data[idx] - lo) > span)
+	{
+		++idx;
+	}
+	return idx;
+}
+
+uint16 ICACHE_FLASH_ATTR byte_scan_first(const uint8* data, uint16 length, uint8 value)
+{
+	uint16 idx = 0;
+
+	// Short buffers take plain loop, without alignment and word pattern setup
+	if (length < SWAR_MIN_LENGTH)
+	{
+		while (idx < length && data[idx] != value)
+		{
+			++idx;
+		}
+		return idx;
+	}
+	uint32 pattern = value * BYTES_ONES;
+	// Unaligned head bytes
+	while (idx < length && ((size_t)(data + idx) & (WORD_SZ - 1)))
+	{
+		if (data[idx] == value)
+		{
+			return idx;
+		}
+		++idx;
+	}
+	// Aligned words, little-endian: the lowest matching byte is the first one
+	while (idx + WORD_SZ <= length)
+	{
+		uint32 mask = word_zero_mask(*(const uint32_word*)(data + idx) ^ pattern);
+		if (mask)
+		{
+			return idx + (__builtin_ctz(mask) >> 3);
+		}
+		idx += WORD_SZ;
+	}
+	// Tail bytes
+	while (idx < length && data[idx] != value)
+	{
+		++idx;
+	}
+	return idx;
+}
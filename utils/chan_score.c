@@ -0,0 +1,71 @@
+#include "chan_score.h"
+
+#include <osapi.h>
+
+// Overlap weight (quarters) of access point cost added to channel at given distance from access point channel
+static const uint8 overlap_quarters[] = { 4, 3, 2, 1 };
+
+void ICACHE_FLASH_ATTR chan_score_reset(struct chan_score* score)
+{
+	os_memset(score, 0, sizeof(struct chan_score));
+}
+
+// Accounts access point found by scan. Access points on channels out of scored range are ignored.
+void ICACHE_FLASH_ATTR chan_score_add(struct chan_score* score, uint8 channel, sint8 rssi)
+{
+	sint32 signal = (sint32)rssi - CHAN_SCORE_RSSI_FLOOR;
+	uint32 cost;
+	uint8 idx;
+	if (channel < 1 || channel > CHAN_SCORE_CHANNELS)
+	{
+		return;
+	}
+	if (signal < 0)
+	{
+		signal = 0;
+	}
+	else if (signal > CHAN_SCORE_RSSI_MAX_WEIGHT)
+	{
+		signal = CHAN_SCORE_RSSI_MAX_WEIGHT;
+	}
+	cost = CHAN_SCORE_AP_WEIGHT + signal;
+	if (score->aps[channel - 1] < 0xFF)
+	{
+		score->aps[channel - 1]++;
+	}
+	for (idx = 1; idx <= CHAN_SCORE_CHANNELS; ++idx)
+	{
+		uint8 distance = idx > channel ? idx - channel : channel - idx;
+		if (distance < sizeof(overlap_quarters))
+		{
+			// Scores saturate rather than wrap around on extremely crowded sites
+			uint32 sum = score->scores[idx - 1] + cost * overlap_quarters[distance] / 4;
+			score->scores[idx - 1] = sum < 0xFFFF ? sum : 0xFFFF;
+		}
+	}
+}
+
+uint16 ICACHE_FLASH_ATTR chan_score_get(const struct chan_score* score, uint8 channel)
+{
+	return channel >= 1 && channel <= CHAN_SCORE_CHANNELS ? score->scores[channel - 1] : 0xFFFF;
+}
+
+// Returns channel with the lowest score. Ties are resolved in favour of preferred channel (e.g. current one),
+// then of non-overlapping channels 1, 6 and 11, then of the lowest channel.
+uint8 ICACHE_FLASH_ATTR chan_score_best(const struct chan_score* score, uint8 preferred)
+{
+	uint8 best = 0;
+	uint8 best_rank = 0;
+	uint8 channel;
+	for (channel = 1; channel <= CHAN_SCORE_CHANNELS; ++channel)
+	{
+		uint8 rank = channel == preferred ? 2 : (channel == 1 || channel == 6 || channel == 11) ? 1 : 0;
+		if (!best || score->scores[channel - 1] < score->scores[best - 1]
+				|| (score->scores[channel - 1] == score->scores[best - 1] && rank > best_rank))
+		{
+			best = channel;
+			best_rank = rank;
+		}
+	}
+	return best;
+}
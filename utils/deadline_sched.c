@@ -0,0 +1,232 @@
+#include "deadline_sched.h"
+
+#include <osapi.h>
+#include <user_interface.h>
+
+// Timer is never armed for less than that, so overdue task does not make timer fire from within its own callback
+#define DEADLINE_SCHED_MIN_ARM_MS			1
+
+static os_timer_t* sched_timer = NULL;
+// Registered tasks, in registration order
+static struct deadline_sched_task* tasks[DEADLINE_SCHED_MAX_TASKS];
+static uint8 tasks_count = 0;
+// Binary min-heap of scheduled tasks ordered by deadline
+static struct deadline_sched_task* heap[DEADLINE_SCHED_MAX_TASKS];
+static uint8 heap_size = 0;
+// Set while due tasks are run, timer is re-armed once they are all done
+static bool dispatching = false;
+static struct deadline_sched_stats stats;
+
+LOCAL bool ICACHE_FLASH_ATTR deadline_before(const struct deadline_sched_task* a, const struct deadline_sched_task* b)
+{
+	return (sint32)(a->deadline - b->deadline) < 0;
+}
+
+LOCAL void ICACHE_FLASH_ATTR heap_place(struct deadline_sched_task* task, uint8 index)
+{
+	heap[index] = task;
+	task->heap_index = index;
+}
+
+LOCAL void ICACHE_FLASH_ATTR sift_up(uint8 index)
+{
+	struct deadline_sched_task* task = heap[index];
+	while (index)
+	{
+		uint8 parent = (index - 1) / 2;
+		if (!deadline_before(task, heap[parent]))
+		{
+			break;
+		}
+		heap_place(heap[parent], index);
+		index = parent;
+	}
+	heap_place(task, index);
+}
+
+LOCAL void ICACHE_FLASH_ATTR sift_down(uint8 index)
+{
+	struct deadline_sched_task* task = heap[index];
+	for (;;)
+	{
+		uint8 child = index * 2 + 1;
+		if (child >= heap_size)
+		{
+			break;
+		}
+		if (child + 1 < heap_size && deadline_before(heap[child + 1], heap[child]))
+		{
+			child++;
+		}
+		if (!deadline_before(heap[child], task))
+		{
+			break;
+		}
+		heap_place(heap[child], index);
+		index = child;
+	}
+	heap_place(task, index);
+}
+
+LOCAL void ICACHE_FLASH_ATTR heap_insert(struct deadline_sched_task* task)
+{
+	heap[heap_size] = task;
+	sift_up(heap_size++);
+}
+
+LOCAL void ICACHE_FLASH_ATTR heap_remove(struct deadline_sched_task* task)
+{
+	uint8 index = task->heap_index;
+	struct deadline_sched_task* last = heap[--heap_size];
+	task->heap_index = DEADLINE_SCHED_IDLE;
+	if (last != task)
+	{
+		heap_place(last, index);
+		if (index && deadline_before(last, heap[(index - 1) / 2]))
+		{
+			sift_up(index);
+		}
+		else
+		{
+			sift_down(index);
+		}
+	}
+}
+
+// Arms timer for the earliest deadline, timer stays disarmed while nothing is scheduled
+LOCAL void ICACHE_FLASH_ATTR arm_timer(void)
+{
+	if (dispatching)
+	{
+		return;
+	}
+	os_timer_disarm(sched_timer);
+	if (heap_size)
+	{
+		sint32 delay = (sint32)(heap[0]->deadline - system_get_time());
+		uint32 delay_ms = delay > 0 ? ((uint32)delay + 999) / 1000 : 0;
+		os_timer_arm(sched_timer, delay_ms > DEADLINE_SCHED_MIN_ARM_MS ? delay_ms : DEADLINE_SCHED_MIN_ARM_MS, false);
+	}
+}
+
+LOCAL void ICACHE_FLASH_ATTR schedule(struct deadline_sched_task* task, uint32 deadline, uint32 period)
+{
+	if (task->heap_index != DEADLINE_SCHED_IDLE)
+	{
+		heap_remove(task);
+	}
+	task->deadline = deadline;
+	task->period = period;
+	heap_insert(task);
+	arm_timer();
+}
+
+// Takes timer used to wake up for the earliest deadline. Timer callback is expected to call deadline_sched_run.
+void ICACHE_FLASH_ATTR deadline_sched_init(os_timer_t* timer)
+{
+	sched_timer = timer;
+}
+
+// Adds task to scheduler. Returns false if DEADLINE_SCHED_MAX_TASKS tasks are registered already.
+bool ICACHE_FLASH_ATTR deadline_sched_register(struct deadline_sched_task* task, uint8 id, deadline_sched_fn fn)
+{
+	if (tasks_count >= DEADLINE_SCHED_MAX_TASKS)
+	{
+		return false;
+	}
+	os_memset(task, 0, sizeof(struct deadline_sched_task));
+	task->fn = fn;
+	task->id = id;
+	task->heap_index = DEADLINE_SCHED_IDLE;
+	tasks[tasks_count++] = task;
+	return true;
+}
+
+// Schedules one-shot run at system time deadline. Already scheduled task is rescheduled.
+void ICACHE_FLASH_ATTR deadline_sched_at(struct deadline_sched_task* task, uint32 deadline)
+{
+	schedule(task, deadline, 0);
+}
+
+void ICACHE_FLASH_ATTR deadline_sched_after(struct deadline_sched_task* task, uint32 delay_us)
+{
+	schedule(task, system_get_time() + delay_us, 0);
+}
+
+// Schedules periodic runs, the first one a period from now. Next deadline is advanced from the previous deadline
+// rather than from actual start, so lateness does not accumulate.
+void ICACHE_FLASH_ATTR deadline_sched_every(struct deadline_sched_task* task, uint32 period_us)
+{
+	schedule(task, system_get_time() + period_us, period_us);
+}
+
+void ICACHE_FLASH_ATTR deadline_sched_cancel(struct deadline_sched_task* task)
+{
+	if (task->heap_index != DEADLINE_SCHED_IDLE)
+	{
+		heap_remove(task);
+		arm_timer();
+	}
+}
+
+bool ICACHE_FLASH_ATTR deadline_sched_pending(const struct deadline_sched_task* task)
+{
+	return task->heap_index != DEADLINE_SCHED_IDLE;
+}
+
+// Runs every due task, then re-arms timer for the next deadline. Periodic task is rescheduled before it runs,
+// so task function is free to cancel or reschedule it. Returns number of tasks run.
+uint8 ICACHE_FLASH_ATTR deadline_sched_run(void)
+{
+	uint8 runs = 0;
+	uint32 now = system_get_time();
+	dispatching = true;
+	stats.wakeups++;
+	while (heap_size && (sint32)(now - heap[0]->deadline) >= 0)
+	{
+		struct deadline_sched_task* task = heap[0];
+		uint32 lateness = now - task->deadline;
+		heap_remove(task);
+		task->jitter.runs++;
+		task->jitter.last = lateness;
+		task->jitter.sum += lateness;
+		if (lateness > task->jitter.max)
+		{
+			task->jitter.max = lateness;
+		}
+		if (task->period)
+		{
+			uint32 skipped = lateness / task->period;
+			task->jitter.overruns += skipped;
+			task->deadline += (skipped + 1) * task->period;
+			heap_insert(task);
+		}
+		task->fn(task);
+		runs++;
+		now = system_get_time();
+	}
+	if (!runs)
+	{
+		stats.early_wakeups++;
+	}
+	stats.runs += runs;
+	dispatching = false;
+	arm_timer();
+	return runs;
+}
+
+uint8 ICACHE_FLASH_ATTR deadline_sched_count(void)
+{
+	return tasks_count;
+}
+
+// Returns registered task by registration index, NULL if index is out of range
+const struct deadline_sched_task* ICACHE_FLASH_ATTR deadline_sched_get(uint8 index)
+{
+	return index < tasks_count ? tasks[index] : NULL;
+}
+
+const struct deadline_sched_stats* ICACHE_FLASH_ATTR deadline_sched_get_stats(void)
+{
+	return &stats;
+}
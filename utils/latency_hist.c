@@ -0,0 +1,47 @@
+#include "latency_hist.h"
+
+#include <osapi.h>
+
+void ICACHE_FLASH_ATTR latency_hist_reset(struct latency_hist* hist)
+{
+	os_memset(hist, 0, sizeof(struct latency_hist));
+}
+
+void ICACHE_FLASH_ATTR latency_hist_add(struct latency_hist* hist, uint32 value)
+{
+	// Bucket is bit length of value: zero has none, __builtin_clz(0) is undefined
+	uint8 bucket = value ? 32 - __builtin_clz(value) : 0;
+	if (bucket > LATENCY_HIST_BUCKETS - 1)
+	{
+		bucket = LATENCY_HIST_BUCKETS - 1;
+	}
+	hist->buckets[bucket]++;
+	hist->count++;
+	if (value > hist->max)
+	{
+		hist->max = value;
+	}
+}
+
+// Returns upper bound of bucket holding given percentile (in 1/1000 units), capped by maximum recorded value
+uint32 ICACHE_FLASH_ATTR latency_hist_percentile(const struct latency_hist* hist, uint16 permille)
+{
+	if (!hist->count)
+	{
+		return 0;
+	}
+	// Rank of the sample, rounded up, so that p50 of two samples is the first one
+	uint32 rank = (uint32)(((uint64)hist->count * permille + 999) / 1000);
+	uint32 seen = 0;
+	uint8 bucket;
+	for (bucket = 0; bucket < LATENCY_HIST_BUCKETS - 1; ++bucket)
+	{
+		seen += hist->buckets[bucket];
+		if (seen >= rank)
+		{
+			break;
+		}
+	}
+	uint32 bound = bucket ? (1U << bucket) - 1 : 0;
+	return bound < hist->max ? bound : hist->max;
+}
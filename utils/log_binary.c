@@ -0,0 +1,108 @@
+#include "log_binary.h"
+
+#include <stdarg.h>
+#include <osapi.h>
+
+#include "log_sink.h"
+
+#if defined(UART_DEBUG_LOGS) && defined(UART_BINARY_LOGS)
+
+// Reads string byte with aligned 32-bit load, as strings kept in flash do not support byte loads
+LOCAL uint8 ICACHE_FLASH_ATTR read_string_byte(const char* str)
+{
+	uint32 offset = (uint32)((size_t)str & 0x03);
+	const uint32* word = (const uint32*)(str - offset);
+	return (uint8)(*word >> (offset * 8));
+}
+
+// Marks arguments which are printed with %s conversion
+LOCAL uint32 ICACHE_FLASH_ATTR string_args_mask(const char* format)
+{
+	uint32 mask = 0;
+	uint8 arg = 0;
+	uint8 c;
+	while ((c = read_string_byte(format++)) != 0)
+	{
+		if (c != '%')
+		{
+			continue;
+		}
+		// Flags, width, precision and length modifiers
+		do
+		{
+			c = read_string_byte(format++);
+		}
+		while (c && os_strchr("-+ #0123456789.hlz", c));
+		if (!c)
+		{
+			break;
+		}
+		if (c == '%')
+		{
+			continue;
+		}
+		if (c == 's')
+		{
+			mask |= 1 << arg;
+		}
+		arg++;
+	}
+	return mask;
+}
+
+LOCAL uint8* ICACHE_FLASH_ATTR put_varint(uint8* out, uint32 value)
+{
+	while (value >= 0x80)
+	{
+		*out++ = (uint8)(value | 0x80);
+		value >>= 7;
+	}
+	*out++ = (uint8)value;
+	return out;
+}
+
+// Encodes log statement as binary record and queues it for UART output. Format is passed only
+// by call sites with %s arguments, all other arguments are 32-bit words.
+void ICACHE_FLASH_ATTR log_binary_write(uint16 id, const char* string_format, uint8 nargs, ...)
+{
+	uint8 record[LOG_BINARY_HEADER_SZ + LOG_BINARY_PAYLOAD_MAX];
+	uint8* out = record + LOG_BINARY_HEADER_SZ;
+	uint32 strings = string_format ? string_args_mask(string_format) : 0;
+	va_list args;
+	uint8 idx;
+
+	va_start(args, nargs);
+	for (idx = 0; idx < nargs; ++idx)
+	{
+		if (strings & (1 << idx))
+		{
+			const char* str = va_arg(args, const char*);
+			// Room for numbers which follow is kept, so that only strings are ever truncated
+			sint32 room = (record + sizeof(record) - out) - LOG_BINARY_VARINT_MAX * (nargs - idx);
+			uint32 length = 0;
+			while (length < LOG_BINARY_STRING_MAX && (sint32)length < room && read_string_byte(str + length))
+			{
+				length++;
+			}
+			out = put_varint(out, length);
+			uint32 pos;
+			for (pos = 0; pos < length; ++pos)
+			{
+				*out++ = read_string_byte(str + pos);
+			}
+		}
+		else
+		{
+			out = put_varint(out, va_arg(args, uint32));
+		}
+	}
+	va_end(args);
+
+	record[0] = LOG_BINARY_MARKER;
+	record[1] = (uint8)id;
+	record[2] = (uint8)(id >> 8);
+	record[3] = (uint8)(out - record - LOG_BINARY_HEADER_SZ);
+	log_sink_write(record, out - record);
+}
+
+#endif
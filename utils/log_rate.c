@@ -0,0 +1,81 @@
+#define LOG_MODULE	LOG_RATE
+
+#include "log_rate.h"
+
+#include <osapi.h>
+#include <user_interface.h>
+
+#include "mod_enums.h"
+
+#ifdef UART_DEBUG_LOGS
+
+// Sites which suppressed messages since boot
+static struct log_site* suppressing_sites = NULL;
+static uint32 last_summary_time = 0;
+
+LOCAL void ICACHE_FLASH_ATTR suppress(struct log_site* site, uint16 id)
+{
+	site->suppressed++;
+	if (!site->id)
+	{
+		site->id = id;
+		site->next = suppressing_sites;
+		suppressing_sites = site;
+	}
+}
+
+// Decides whether call site message is logged: 1 in sample messages passes sampling,
+// then it takes one token of site bucket
+bool ICACHE_FLASH_ATTR log_rate_allow(struct log_site* site, uint16 id, uint16 sample)
+{
+	if (sample > 1)
+	{
+		uint16 position = site->sample_count;
+		site->sample_count = position + 1 < sample ? position + 1 : 0;
+		if (position)
+		{
+			suppress(site, id);
+			return false;
+		}
+	}
+	uint32 now = system_get_time();
+	sint32 ahead = (sint32)(site->full_time - now);
+	// Bucket is full; also state of a site silent for over half of timer range, whose time difference wrapped
+	if (ahead < 0 || ahead > LOG_RATE_BURST * LOG_RATE_INTERVAL_US)
+	{
+		site->full_time = now;
+		ahead = 0;
+	}
+	if (ahead > (LOG_RATE_BURST - 1) * LOG_RATE_INTERVAL_US)
+	{
+		suppress(site, id);
+		return false;
+	}
+	site->full_time += LOG_RATE_INTERVAL_US;
+	return true;
+}
+
+// Periodically reports number of messages suppressed by each site. Summary bypasses rate limiting.
+void ICACHE_FLASH_ATTR log_rate_poll(void)
+{
+	uint32 now = system_get_time();
+	if (now - last_summary_time < LOG_RATE_SUMMARY_MS * 1000)
+	{
+		return;
+	}
+	last_summary_time = now;
+	struct log_site* site;
+	for (site = suppressing_sites; site; site = site->next)
+	{
+		if (site->suppressed)
+		{
+#if LOG_ENABLED(LOG_LEVEL_WARN)
+			OS_UART_LOG_EMIT("[WARN] Log site %d:%d suppressed %d messages\n", site->id >> LOG_BINARY_LINE_BITS,
+					site->id & ((1 << LOG_BINARY_LINE_BITS) - 1), site->suppressed);
+#endif
+			site->suppressed = 0;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,83 @@
+#define LOG_MODULE	DUMP
+
+#include "mod_dump.h"
+
+#include <osapi.h>
+
+#include "mod_enums.h"
+
+#ifdef UART_DEBUG_LOGS
+
+// Dump line: 4 offset digits, ": ", 3 chars per hex byte, " |", ASCII chars, "|", new line and terminating zero
+#define DUMP_LINE_SZ						(4 + 2 + 3 * DUMP_BYTES_PER_LINE + 2 + DUMP_BYTES_PER_LINE + 3)
+
+#if DUMP_LINE_SZ - 1 > LOG_BINARY_STRING_MAX
+#error "Dump line does not fit into binary log string argument"
+#endif
+
+static const char hex_digits[] = "0123456789abcdef";
+// Static scratch buffer, so dumping never touches the heap
+static char dump_line[DUMP_LINE_SZ];
+
+// Formats single dump line of up to DUMP_BYTES_PER_LINE bytes
+LOCAL void ICACHE_FLASH_ATTR format_dump_line(const uint8* data, uint16 offset, uint8 count)
+{
+	char* out = dump_line;
+	uint8 idx;
+
+	*out++ = hex_digits[(offset >> 12) & 0x0F];
+	*out++ = hex_digits[(offset >> 8) & 0x0F];
+	*out++ = hex_digits[(offset >> 4) & 0x0F];
+	*out++ = hex_digits[offset & 0x0F];
+	*out++ = ':';
+	*out++ = ' ';
+	for (idx = 0; idx < DUMP_BYTES_PER_LINE; ++idx)
+	{
+		if (idx < count)
+		{
+			*out++ = hex_digits[data[idx] >> 4];
+			*out++ = hex_digits[data[idx] & 0x0F];
+		}
+		else
+		{
+			*out++ = ' ';
+			*out++ = ' ';
+		}
+		*out++ = ' ';
+	}
+	*out++ = ' ';
+	*out++ = '|';
+	for (idx = 0; idx < count; ++idx)
+	{
+		*out++ = (data[idx] >= 0x20 && data[idx] < 0x7F) ? (char)data[idx] : '.';
+	}
+	*out++ = '|';
+	*out++ = '\n';
+	*out = 0;
+}
+
+// Prints hex/ASCII dump of received payload to UART. Output is truncated to UART_DEBUG_DUMP_BYTES bytes,
+// so large segments don't hold network callback for the whole UART transfer time.
+void ICACHE_FLASH_ATTR dump_payload(const char* data, uint16 length)
+{
+	uint16 shown = length < UART_DEBUG_DUMP_BYTES ? length : UART_DEBUG_DUMP_BYTES;
+	uint16 offset;
+	uint8 count;
+
+	if (shown < length)
+	{
+		OS_UART_LOG_DEBUG("Received package content (first %d of %d bytes):\n", shown, length);
+	}
+	else
+	{
+		OS_UART_LOG_DEBUG("Received package content:\n");
+	}
+	for (offset = 0; offset < shown; offset += count)
+	{
+		count = (shown - offset) < DUMP_BYTES_PER_LINE ? (uint8)(shown - offset) : DUMP_BYTES_PER_LINE;
+		format_dump_line((const uint8*)data + offset, offset, count);
+		OS_UART_LOG_DEBUG("%s", dump_line);
+	}
+}
+
+#endif
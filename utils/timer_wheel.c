@@ -0,0 +1,72 @@
+#include "timer_wheel.h"
+
+#include <osapi.h>
+
+LOCAL void ICACHE_FLASH_ATTR link_entry(struct timer_wheel* wheel, struct timer_wheel_entry* entry)
+{
+	struct timer_wheel_entry** bucket = &wheel->buckets[entry->expires & (TIMER_WHEEL_BUCKETS - 1)];
+	entry->next = *bucket;
+	if (entry->next)
+	{
+		entry->next->pprev = &entry->next;
+	}
+	entry->pprev = bucket;
+	*bucket = entry;
+}
+
+void ICACHE_FLASH_ATTR timer_wheel_init(struct timer_wheel* wheel)
+{
+	os_memset(wheel, 0, sizeof(struct timer_wheel));
+}
+
+// Schedules entry to expire in given number of ticks (at least 1). Already scheduled entry is rescheduled.
+void ICACHE_FLASH_ATTR timer_wheel_schedule(struct timer_wheel* wheel, struct timer_wheel_entry* entry, uint32 ticks)
+{
+	timer_wheel_cancel(entry);
+	entry->expires = wheel->now + (ticks ? ticks : 1);
+	link_entry(wheel, entry);
+}
+
+void ICACHE_FLASH_ATTR timer_wheel_cancel(struct timer_wheel_entry* entry)
+{
+	if (entry->pprev)
+	{
+		*entry->pprev = entry->next;
+		if (entry->next)
+		{
+			entry->next->pprev = entry->pprev;
+		}
+		entry->next = NULL;
+		entry->pprev = NULL;
+	}
+}
+
+// Advances wheel by one tick and calls expired_fn for every expired entry. Entry is unlinked before the call,
+// so callback is free to reschedule it, but it should not cancel other entries.
+void ICACHE_FLASH_ATTR timer_wheel_advance(struct timer_wheel* wheel, timer_wheel_expired_fn expired_fn)
+{
+	struct timer_wheel_entry** bucket;
+	struct timer_wheel_entry* entry;
+	struct timer_wheel_entry* next;
+
+	wheel->now++;
+	bucket = &wheel->buckets[wheel->now & (TIMER_WHEEL_BUCKETS - 1)];
+	// Bucket is detached first: entries due on later revolutions are linked back, expired ones are reported
+	entry = *bucket;
+	*bucket = NULL;
+	while (entry)
+	{
+		next = entry->next;
+		entry->next = NULL;
+		entry->pprev = NULL;
+		if ((sint32)(entry->expires - wheel->now) > 0)
+		{
+			link_entry(wheel, entry);
+		}
+		else
+		{
+			expired_fn(entry);
+		}
+		entry = next;
+	}
+}
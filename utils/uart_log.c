@@ -0,0 +1,148 @@
+#define LOG_MODULE	UART_LOG
+
+#include "uart_log.h"
+
+#include <ets_sys.h>
+#include <osapi.h>
+
+#include "mod_enums.h"
+
+#ifdef UART_DEBUG_LOGS
+
+// Single producer (os_printf from SDK task context) / single consumer (UART interrupt) ring:
+// producer only advances head, consumer only advances tail
+static char ring[UART_LOG_RING_SZ];
+static volatile uint32 head = 0;
+static volatile uint32 tail = 0;
+static struct uart_log_stats stats;
+// Set while the rest of a line which did not fit into ring is being dropped
+static bool dropping = false;
+// Dropped lines already reported by uart_log_poll
+static uint32 reported_drops = 0;
+
+// Copies as many pending bytes as TX FIFO can take. Runs in interrupt context, so it is kept in IRAM.
+LOCAL void fill_tx_fifo(void)
+{
+	uint32 fifo_free = UART_LOG_FIFO_SZ
+			- ((READ_PERI_REG(UART_LOG_STATUS) >> UART_LOG_TXFIFO_CNT_S) & UART_LOG_TXFIFO_CNT);
+	uint32 pos = tail;
+	while (fifo_free && pos != head)
+	{
+		WRITE_PERI_REG(UART_LOG_FIFO, ring[pos & (UART_LOG_RING_SZ - 1)]);
+		pos++;
+		fifo_free--;
+	}
+	stats.drained += pos - tail;
+	tail = pos;
+}
+
+LOCAL void uart_log_isr(void* arg)
+{
+	(void)arg;
+	uint32 status = READ_PERI_REG(UART_LOG_INT_ST);
+	if (status & UART_LOG_TXFIFO_EMPTY_INT)
+	{
+		fill_tx_fifo();
+		if (tail == head)
+		{
+			CLEAR_PERI_REG_MASK(UART_LOG_INT_ENA, UART_LOG_TXFIFO_EMPTY_INT);
+		}
+	}
+	WRITE_PERI_REG(UART_LOG_INT_CLR, status);
+}
+
+LOCAL void ring_put(char c)
+{
+	ring[head & (UART_LOG_RING_SZ - 1)] = c;
+	head++;
+	stats.written++;
+	// Drain is started once per line rather than per character
+	if (c == '\n')
+	{
+		SET_PERI_REG_MASK(UART_LOG_INT_ENA, UART_LOG_TXFIFO_EMPTY_INT);
+	}
+}
+
+// Character output routine of os_printf: never waits for UART, line tail is dropped when ring is full
+void uart_log_putc(char c)
+{
+	if (dropping)
+	{
+		dropping = c != '\n';
+		return;
+	}
+	uint32 used = head - tail;
+	if (used >= UART_LOG_RING_SZ - 1 && c != '\n')
+	{
+		// Last free byte terminates truncated line, so that following lines are not garbled
+		if (used < UART_LOG_RING_SZ)
+		{
+			ring_put('\n');
+		}
+		stats.dropped_lines++;
+		dropping = true;
+		return;
+	}
+	if (used >= UART_LOG_RING_SZ)
+	{
+		stats.dropped_lines++;
+		return;
+	}
+	ring_put(c);
+}
+
+// Queues binary log record as a whole or drops it, so the record is never cut
+bool ICACHE_FLASH_ATTR uart_log_write(const uint8* data, uint16 length)
+{
+	if (UART_LOG_RING_SZ - (head - tail) < length)
+	{
+		stats.dropped_lines++;
+		return false;
+	}
+	uint16 idx;
+	for (idx = 0; idx < length; ++idx)
+	{
+		ring[(head + idx) & (UART_LOG_RING_SZ - 1)] = data[idx];
+	}
+	head += length;
+	stats.written += length;
+	SET_PERI_REG_MASK(UART_LOG_INT_ENA, UART_LOG_TXFIFO_EMPTY_INT);
+	return true;
+}
+
+// Redirects os_printf output to log ring drained by UART TX FIFO empty interrupt.
+// Has to be called after uart_init, UART interrupt handler of UART driver (RX) is replaced.
+void ICACHE_FLASH_ATTR uart_log_init(void)
+{
+	ETS_UART_INTR_DISABLE();
+	ETS_UART_INTR_ATTACH(uart_log_isr, NULL);
+	WRITE_PERI_REG(UART_LOG_INT_ENA, 0);
+	WRITE_PERI_REG(UART_LOG_INT_CLR, 0xFFFF);
+	WRITE_PERI_REG(UART_LOG_CONF1, (READ_PERI_REG(UART_LOG_CONF1)
+			& ~(UART_LOG_TXFIFO_EMPTY_THRHD << UART_LOG_TXFIFO_EMPTY_THRHD_S))
+			| (UART_LOG_TXFIFO_REFILL_LEVEL << UART_LOG_TXFIFO_EMPTY_THRHD_S));
+	os_install_putc1((void*)uart_log_putc);
+	ETS_UART_INTR_ENABLE();
+}
+
+// Periodic housekeeping: restarts drain of partial lines and reports dropped lines
+void ICACHE_FLASH_ATTR uart_log_poll(void)
+{
+	if (stats.dropped_lines != reported_drops)
+	{
+		uint32 dropped = stats.dropped_lines - reported_drops;
+		reported_drops = stats.dropped_lines;
+		OS_UART_LOG_WARN("UART log ring full, %d lines truncated or records dropped\n", dropped);
+	}
+	if (tail != head)
+	{
+		SET_PERI_REG_MASK(UART_LOG_INT_ENA, UART_LOG_TXFIFO_EMPTY_INT);
+	}
+}
+
+const struct uart_log_stats* ICACHE_FLASH_ATTR uart_log_get_stats(void)
+{
+	return &stats;
+}
+
+#endif